@@ -1,6 +1,29 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include "MappedFile.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h> // _addcarry_u64
+#endif
 
 using namespace std;
 
@@ -26,15 +49,22 @@ int binaryToInteger(const vector<bool>& binary) {
     return result;
 }
 
+// Zero-extend a binary number (MSB first) to the given width
+vector<bool> padToWidth(const vector<bool>& binary, size_t width) {
+    vector<bool> padded(width - binary.size(), 0);
+    padded.insert(padded.end(), binary.begin(), binary.end());
+    return padded;
+}
+
 //// Half Adder ////
-void halfAdder(bool A, bool B, bool &Sum, bool &Carry) {
+constexpr void halfAdder(bool A, bool B, bool &Sum, bool &Carry) {
     Sum = A ^ B;     // XOR for Sum
     Carry = A & B;   // AND for Carry
 }
 
 //// Full Adder ////
-void fullAdder(bool A, bool B, bool Cin, bool &Sum, bool &Carry) {
-    bool intermediateSum, intermediateCarry1, intermediateCarry2;
+constexpr void fullAdder(bool A, bool B, bool Cin, bool &Sum, bool &Carry) {
+    bool intermediateSum = 0, intermediateCarry1 = 0, intermediateCarry2 = 0;
     halfAdder(A, B, intermediateSum, intermediateCarry1);
     halfAdder(intermediateSum, Cin, Sum, intermediateCarry2);
     Carry = intermediateCarry1 | intermediateCarry2; // OR for final Carry
@@ -44,26 +74,26 @@ void fullAdder(bool A, bool B, bool Cin, bool &Sum, bool &Carry) {
 void serialAdder(const vector<bool>& A, const vector<bool>& B, vector<bool>& Sum, bool& Carry) {
     Carry = 0; // Initialize Carry
     size_t size = max(A.size(), B.size());
-    vector<bool> paddedA = A, paddedB = B;
-    paddedA.resize(size, 0);
-    paddedB.resize(size, 0);
+    vector<bool> paddedA = padToWidth(A, size), paddedB = padToWidth(B, size);
     Sum.resize(size);
     for (size_t i = size; i-- > 0;) {
-        fullAdder(paddedA[i], paddedB[i], Carry, Sum[i], Carry);
+        bool bitSum;
+        fullAdder(paddedA[i], paddedB[i], Carry, bitSum, Carry);
+        Sum[i] = bitSum;
     }
 }
 
 //// Parallel Adder ////
 vector<bool> parallelAdder(const vector<bool>& A, const vector<bool>& B) {
     size_t size = max(A.size(), B.size());
-    vector<bool> paddedA = A, paddedB = B;
-    paddedA.resize(size, 0);
-    paddedB.resize(size, 0);
+    vector<bool> paddedA = padToWidth(A, size), paddedB = padToWidth(B, size);
     vector<bool> Sum(size);
     bool Carry = 0;
 
     for (size_t i = size; i-- > 0;) {
-        fullAdder(paddedA[i], paddedB[i], Carry, Sum[i], Carry);
+        bool bitSum;
+        fullAdder(paddedA[i], paddedB[i], Carry, bitSum, Carry);
+        Sum[i] = bitSum;
     }
     if (Carry) Sum.insert(Sum.begin(), Carry); // Add final carry if needed
     return Sum;
@@ -72,14 +102,14 @@ vector<bool> parallelAdder(const vector<bool>& A, const vector<bool>& B) {
 //// Parallel Subtractor ////
 vector<bool> parallelSubtractor(const vector<bool>& A, const vector<bool>& B) {
     size_t size = max(A.size(), B.size());
-    vector<bool> paddedA = A, paddedB = B;
-    paddedA.resize(size, 0);
-    paddedB.resize(size, 0);
+    vector<bool> paddedA = padToWidth(A, size), paddedB = padToWidth(B, size);
     vector<bool> Difference(size);
-    bool Borrow = 0;
+    bool Borrow = 1; // Carry-in of 1 completes the Two's Complement of B
 
     for (size_t i = size; i-- > 0;) {
-        fullAdder(paddedA[i], !paddedB[i], Borrow, Difference[i], Borrow); // Subtraction as A - B = A + NOT(B)
+        bool bitDifference;
+        fullAdder(paddedA[i], !paddedB[i], Borrow, bitDifference, Borrow); // Subtraction as A - B = A + NOT(B) + 1
+        Difference[i] = bitDifference;
     }
     return Difference;
 }
@@ -93,25 +123,19 @@ void additionSubtractionALU(const vector<bool>& A, const vector<bool>& B, bool m
     }
 }
 
-//// Fast Adder ////
-vector<bool> fastAdder(const vector<bool>& A, const vector<bool>& B) {
-    return parallelAdder(A, B); // Built on Parallel Adder logic
-}
-
 //// Carry Lookahead Adder ////
 vector<bool> carryLookaheadAdder(const vector<bool>& A, const vector<bool>& B) {
     size_t size = max(A.size(), B.size());
-    vector<bool> paddedA = A, paddedB = B;
-    paddedA.resize(size, 0);
-    paddedB.resize(size, 0);
+    vector<bool> paddedA = padToWidth(A, size), paddedB = padToWidth(B, size);
 
     vector<bool> Sum(size);
     vector<bool> Generate(size), Propagate(size), Carry(size + 1);
 
+    // Bit positions are counted from the LSB, which is the last element of each vector
     // Step 1: Compute Generate and Propagate
     for (size_t i = 0; i < size; i++) {
-        Generate[i] = paddedA[i] & paddedB[i];   // G = A AND B
-        Propagate[i] = paddedA[i] ^ paddedB[i]; // P = A XOR B
+        Generate[i] = paddedA[size - 1 - i] & paddedB[size - 1 - i];   // G = A AND B
+        Propagate[i] = paddedA[size - 1 - i] ^ paddedB[size - 1 - i]; // P = A XOR B
     }
 
     // Step 2: Compute Carry
@@ -122,26 +146,1525 @@ vector<bool> carryLookaheadAdder(const vector<bool>& A, const vector<bool>& B) {
 
     // Step 3: Compute Sum
     for (size_t i = 0; i < size; i++) {
-        Sum[i] = Propagate[i] ^ Carry[i]; // S[i] = P[i] XOR C[i]
+        Sum[size - 1 - i] = Propagate[i] ^ Carry[i]; // S[i] = P[i] XOR C[i]
     }
 
     if (Carry[size]) Sum.insert(Sum.begin(), Carry[size]); // Append the final carry
     return Sum;
 }
 
+//// Fixed-Width Adders ////
+
+// N-bit operand held in 64-bit words inside the object (word 0 holds bits 0-63), so the fixed-width
+// adders never touch the heap and can run in constant expressions
+template <size_t N>
+struct FixedOperand {
+    array<uint64_t, (N + 63) / 64> words{};
+
+    constexpr bool bit(size_t i) const {
+        return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    constexpr void setBit(size_t i, bool value) {
+        uint64_t mask = (uint64_t)1 << (i % 64);
+        words[i / 64] = value ? words[i / 64] | mask : words[i / 64] & ~mask;
+    }
+
+    // Low 64 bits as an integer
+    constexpr uint64_t toInteger() const {
+        return words[0];
+    }
+
+    static constexpr FixedOperand fromInteger(uint64_t value) {
+        FixedOperand operand;
+        for (size_t i = 0; i < N && i < 64; i++) operand.setBit(i, (value >> i) & 1);
+        return operand;
+    }
+
+    bitset<N> toBitset() const {
+        bitset<N> bits;
+        for (size_t i = 0; i < N; i++) bits[i] = bit(i);
+        return bits;
+    }
+
+    // Dynamic-width interop: binary numbers are MSB first, zero-extended or truncated to N bits
+    static FixedOperand fromBinary(const vector<bool>& binary) {
+        FixedOperand operand;
+        size_t size = binary.size();
+        for (size_t j = 0; j < size && j < N; j++) operand.setBit(j, binary[size - 1 - j]);
+        return operand;
+    }
+
+    vector<bool> toBinary(size_t width = N) const {
+        vector<bool> binary(width);
+        for (size_t j = 0; j < width && j < N; j++) binary[width - 1 - j] = bit(j);
+        return binary;
+    }
+};
+
+using Operand8 = FixedOperand<8>;
+using Operand16 = FixedOperand<16>;
+using Operand32 = FixedOperand<32>;
+using Operand64 = FixedOperand<64>;
+
+template <size_t N>
+struct FixedSum {
+    FixedOperand<N> Sum;
+    bool Carry;
+};
+
+// Ripple of fullAdder over N bits, as parallelAdder but without padding or resizing
+template <size_t N>
+constexpr FixedSum<N> fixedParallelAdder(const FixedOperand<N>& A, const FixedOperand<N>& B, bool carryIn = 0) {
+    FixedSum<N> result{};
+    bool Carry = carryIn;
+    for (size_t i = 0; i < N; i++) {
+        bool bitSum = 0;
+        fullAdder(A.bit(i), B.bit(i), Carry, bitSum, Carry);
+        result.Sum.setBit(i, bitSum);
+    }
+    result.Carry = Carry;
+    return result;
+}
+
+// A - B = A + NOT(B) + 1, wrapping at N bits
+template <size_t N>
+constexpr FixedOperand<N> fixedParallelSubtractor(const FixedOperand<N>& A, const FixedOperand<N>& B) {
+    FixedOperand<N> notB;
+    for (size_t i = 0; i < N; i++) notB.setBit(i, !B.bit(i));
+    return fixedParallelAdder(A, notB, 1).Sum;
+}
+
+// Generate/Propagate form of the same addition, as carryLookaheadAdder
+template <size_t N>
+constexpr FixedSum<N> fixedCarryLookaheadAdder(const FixedOperand<N>& A, const FixedOperand<N>& B) {
+    FixedSum<N> result{};
+    bool Carry = 0;
+    for (size_t i = 0; i < N; i++) {
+        bool Generate = A.bit(i) & B.bit(i);
+        bool Propagate = A.bit(i) ^ B.bit(i);
+        result.Sum.setBit(i, Propagate ^ Carry);
+        Carry = Generate | (Propagate & Carry);
+    }
+    result.Carry = Carry;
+    return result;
+}
+
+// mode 1 adds, mode 0 subtracts (the carry is only meaningful for addition)
+template <size_t N>
+constexpr FixedSum<N> fixedAdditionSubtractionALU(const FixedOperand<N>& A, const FixedOperand<N>& B, bool mode) {
+    if (mode) return fixedParallelAdder(A, B);
+    return FixedSum<N>{fixedParallelSubtractor(A, B), 0};
+}
+
+// Operands known at compile time fold to constants
+static_assert(fixedParallelAdder(Operand8::fromInteger(200), Operand8::fromInteger(100)).Sum.toInteger() == 44 &&
+              fixedParallelAdder(Operand8::fromInteger(200), Operand8::fromInteger(100)).Carry, "8-bit wrap-around");
+static_assert(fixedParallelSubtractor(Operand16::fromInteger(5), Operand16::fromInteger(3)).toInteger() == 2,
+              "16-bit subtraction");
+
+// Run a pair of binary numbers of at most N bits through the N-bit adder, giving parallelAdder's result
+template <size_t N>
+vector<bool> fixedWidthAdderFor(const vector<bool>& A, const vector<bool>& B, size_t size) {
+    FixedSum<N> result = fixedParallelAdder(FixedOperand<N>::fromBinary(A), FixedOperand<N>::fromBinary(B));
+    bool Carry = size < N ? result.Sum.bit(size) : result.Carry; // Carry out of the operands' own width
+    vector<bool> Sum = result.Sum.toBinary(size + Carry);
+    if (Carry) Sum[0] = 1;
+    return Sum;
+}
+
+// parallelAdder on the fixed 8/16/32/64-bit templates, falling back to the dynamic-width adder beyond 64 bits
+vector<bool> fixedWidthAdder(const vector<bool>& A, const vector<bool>& B) {
+    size_t size = max(A.size(), B.size());
+    if (size <= 8) return fixedWidthAdderFor<8>(A, B, size);
+    if (size <= 16) return fixedWidthAdderFor<16>(A, B, size);
+    if (size <= 32) return fixedWidthAdderFor<32>(A, B, size);
+    if (size <= 64) return fixedWidthAdderFor<64>(A, B, size);
+    return parallelAdder(A, B);
+}
+
+//// Bit-Sliced Adder Engine ////
+
+// A slice holds one bit position of 64 independent operands: bit k of slice j is bit j (LSB = 0) of lane k
+const size_t SLICE_LANES = 64;
+
+// Transpose operands [first, first + count) into bit slices, zero-extended to the given width
+vector<uint64_t> packSlices(const vector<vector<bool>>& operands, size_t first, size_t count, size_t width) {
+    vector<uint64_t> slices(width, 0);
+    for (size_t lane = 0; lane < count; lane++) {
+        const vector<bool>& operand = operands[first + lane];
+        size_t size = operand.size();
+        for (size_t j = 0; j < size; j++) {
+            if (operand[size - 1 - j]) slices[j] |= (uint64_t)1 << lane;
+        }
+    }
+    return slices;
+}
+
+// Extract one lane from a slice array as a binary number (MSB first) of the given width
+vector<bool> unpackLane(const vector<uint64_t>& slices, size_t lane, size_t width) {
+    vector<bool> binary(width);
+    for (size_t j = 0; j < width; j++) {
+        binary[width - 1 - j] = (slices[j] >> lane) & 1;
+    }
+    return binary;
+}
+
+// Sliced Full Adder: the fullAdder gate equations evaluated for all 64 lanes at once
+inline void slicedFullAdder(uint64_t A, uint64_t B, uint64_t Cin, uint64_t& Sum, uint64_t& Carry) {
+    uint64_t intermediateSum = A ^ B;
+    Sum = intermediateSum ^ Cin;
+    Carry = (A & B) | (intermediateSum & Cin);
+}
+
+// Ripple A + B (or A + NOT(B) + 1 when subtracting) over sliced operands; returns the carry-out slice
+uint64_t slicedRippleAdd(const uint64_t* A, const uint64_t* B, uint64_t* Sum, size_t width, bool subtract) {
+    uint64_t invert = subtract ? ~(uint64_t)0 : 0;
+    uint64_t Carry = invert; // Carry-in of 1 per lane for subtraction
+    for (size_t j = 0; j < width; j++) {
+        slicedFullAdder(A[j], B[j] ^ invert, Carry, Sum[j], Carry);
+    }
+    return Carry;
+}
+
+// Generate/Propagate lookahead over sliced operands; returns the carry-out slice
+uint64_t slicedCarryLookaheadAdd(const uint64_t* A, const uint64_t* B, uint64_t* Sum, size_t width) {
+    uint64_t Carry = 0;
+    for (size_t j = 0; j < width; j++) {
+        uint64_t Generate = A[j] & B[j];
+        uint64_t Propagate = A[j] ^ B[j];
+        Sum[j] = Propagate ^ Carry;
+        Carry = Generate | (Propagate & Carry);
+    }
+    return Carry;
+}
+
+// Shared driver: evaluates every pair 64 lanes per pass with the given sliced kernel and unpacks each lane
+// at its own width, which gives the same Sum/Carry as running serialAdder on each pair (Carries are left 0
+// for subtraction)
+template <typename SlicedKernel>
+void bitSlicedEvaluate(const vector<vector<bool>>& A, const vector<vector<bool>>& B, bool subtract, SlicedKernel kernel,
+                       vector<vector<bool>>& Sums, vector<bool>& Carries) {
+    size_t pairs = min(A.size(), B.size());
+    Sums.assign(pairs, vector<bool>());
+    Carries.assign(pairs, 0);
+
+    for (size_t first = 0; first < pairs; first += SLICE_LANES) {
+        size_t count = min(SLICE_LANES, pairs - first);
+        size_t width = 0;
+        for (size_t k = first; k < first + count; k++) width = max(width, max(A[k].size(), B[k].size()));
+
+        vector<uint64_t> slicedA = packSlices(A, first, count, width);
+        vector<uint64_t> slicedB = packSlices(B, first, count, width);
+        vector<uint64_t> slicedSum(width + 1, 0);
+        slicedSum[width] = kernel(slicedA.data(), slicedB.data(), slicedSum.data(), width);
+
+        for (size_t lane = 0; lane < count; lane++) {
+            size_t laneWidth = max(A[first + lane].size(), B[first + lane].size());
+            Sums[first + lane] = unpackLane(slicedSum, lane, laneWidth);
+            // A zero-extended lane's carry out of its own width lands in slice laneWidth
+            if (!subtract) Carries[first + lane] = (slicedSum[laneWidth] >> lane) & 1;
+        }
+    }
+}
+
+// Sliced kernels for the batch functions below
+uint64_t slicedAddKernel(const uint64_t* A, const uint64_t* B, uint64_t* Sum, size_t width) {
+    return slicedRippleAdd(A, B, Sum, width, false);
+}
+
+uint64_t slicedSubtractKernel(const uint64_t* A, const uint64_t* B, uint64_t* Sum, size_t width) {
+    return slicedRippleAdd(A, B, Sum, width, true);
+}
+
+// Adds the final carry as a new MSB, as parallelAdder does
+void appendFinalCarries(vector<vector<bool>>& Sums, const vector<bool>& Carries) {
+    for (size_t k = 0; k < Sums.size(); k++) {
+        if (Carries[k]) Sums[k].insert(Sums[k].begin(), 1);
+    }
+}
+
+// Batch form of parallelAdder
+vector<vector<bool>> bitSlicedParallelAdder(const vector<vector<bool>>& A, const vector<vector<bool>>& B) {
+    vector<vector<bool>> Sums;
+    vector<bool> Carries;
+    bitSlicedEvaluate(A, B, false, slicedAddKernel, Sums, Carries);
+    appendFinalCarries(Sums, Carries);
+    return Sums;
+}
+
+// Batch form of parallelSubtractor
+vector<vector<bool>> bitSlicedParallelSubtractor(const vector<vector<bool>>& A, const vector<vector<bool>>& B) {
+    vector<vector<bool>> Differences;
+    vector<bool> Borrows;
+    bitSlicedEvaluate(A, B, true, slicedSubtractKernel, Differences, Borrows);
+    return Differences;
+}
+
+// Batch form of serialAdder
+void bitSlicedSerialAdder(const vector<vector<bool>>& A, const vector<vector<bool>>& B,
+                          vector<vector<bool>>& Sums, vector<bool>& Carries) {
+    bitSlicedEvaluate(A, B, false, slicedAddKernel, Sums, Carries);
+}
+
+// Batch form of carryLookaheadAdder
+vector<vector<bool>> bitSlicedCarryLookaheadAdder(const vector<vector<bool>>& A, const vector<vector<bool>>& B) {
+    vector<vector<bool>> Sums;
+    vector<bool> Carries;
+    bitSlicedEvaluate(A, B, false, slicedCarryLookaheadAdd, Sums, Carries);
+    appendFinalCarries(Sums, Carries);
+    return Sums;
+}
+
+//// Parallel-Prefix Adders ////
+
+// Prefix network topologies; all resolve the carries in O(log n) combine levels
+enum PrefixTopology {
+    KoggeStone, // log2(n) levels, a cell at every bit on every level
+    BrentKung,  // 2 log2(n) - 1 levels, fewest cells
+    Sklansky    // log2(n) levels, fewer cells than Kogge-Stone but high fan-out
+};
+
+string topologyName(PrefixTopology topology) {
+    switch (topology) {
+    case KoggeStone: return "Kogge-Stone";
+    case BrentKung: return "Brent-Kung";
+    case Sklansky: return "Sklansky";
+    }
+    return "Unknown";
+}
+
+// Visits every prefix cell level by level; cell (i, j) merges the group ending at bit i with the
+// adjacent lower group ending at bit j, so after the walk group i spans bits i..0
+template <typename Combine>
+void walkPrefixNetwork(size_t width, PrefixTopology topology, Combine combine) {
+    switch (topology) {
+    case KoggeStone:
+        for (size_t d = 1; d < width; d <<= 1) {
+            for (size_t i = width; i-- > d;) combine(i, i - d); // Descending, so i - d still holds the previous level
+        }
+        break;
+    case Sklansky:
+        for (size_t d = 1; d < width; d <<= 1) {
+            for (size_t i = 0; i < width; i++) {
+                if (i & d) combine(i, (i & ~(2 * d - 1)) + d - 1); // Upper half of each 2d block takes the lower half's top
+            }
+        }
+        break;
+    case BrentKung: {
+        size_t top = 1;
+        for (size_t d = 1; d < width; d <<= 1) { // Up-sweep: build power-of-two groups
+            for (size_t i = 2 * d - 1; i < width; i += 2 * d) combine(i, i - d);
+            top = d;
+        }
+        for (size_t d = top; d > 0; d >>= 1) { // Down-sweep: fill in the remaining prefixes
+            for (size_t i = 3 * d - 1; i < width; i += 2 * d) combine(i, i - d);
+        }
+        break;
+    }
+    }
+}
+
+// Prefix-add sliced operands with the chosen topology; returns the carry-out slice
+uint64_t slicedPrefixAdd(const uint64_t* A, const uint64_t* B, uint64_t* Sum, size_t width, PrefixTopology topology) {
+    if (width == 0) return 0;
+    vector<uint64_t> Generate(width), Propagate(width);
+
+    for (size_t j = 0; j < width; j++) {
+        Generate[j] = A[j] & B[j];  // G = A AND B
+        Propagate[j] = A[j] ^ B[j]; // P = A XOR B
+        Sum[j] = Propagate[j];
+    }
+
+    walkPrefixNetwork(width, topology, [&](size_t i, size_t j) {
+        Generate[i] |= Propagate[i] & Generate[j]; // G[i:k] = G[i:j+1] + P[i:j+1]G[j:k]
+        Propagate[i] &= Propagate[j];              // P[i:k] = P[i:j+1]P[j:k]
+    });
+
+    for (size_t j = 1; j < width; j++) {
+        Sum[j] ^= Generate[j - 1]; // S[j] = P[j] XOR C[j], where C[j] = G[j-1:0]
+    }
+    return Generate[width - 1];
+}
+
+// Run one pair through a sliced kernel in lane 0, with parallelAdder's final-carry convention
+template <typename SlicedKernel>
+vector<bool> singlePairSliced(const vector<bool>& A, const vector<bool>& B, SlicedKernel kernel) {
+    size_t size = max(A.size(), B.size());
+    vector<uint64_t> slicedA = packSlices({A}, 0, 1, size);
+    vector<uint64_t> slicedB = packSlices({B}, 0, 1, size);
+    vector<uint64_t> slicedSum(size);
+    bool Carry = kernel(slicedA.data(), slicedB.data(), slicedSum.data(), size) & 1;
+
+    vector<bool> Sum = unpackLane(slicedSum, 0, size);
+    if (Carry) Sum.insert(Sum.begin(), Carry); // Add final carry if needed
+    return Sum;
+}
+
+// Single-pair prefix adder, same result as parallelAdder
+vector<bool> parallelPrefixAdder(const vector<bool>& A, const vector<bool>& B, PrefixTopology topology) {
+    return singlePairSliced(A, B, [topology](const uint64_t* a, const uint64_t* b, uint64_t* sum, size_t width) {
+        return slicedPrefixAdd(a, b, sum, width, topology);
+    });
+}
+
+// Batch prefix adder, 64 pairs per pass
+vector<vector<bool>> bitSlicedPrefixAdder(const vector<vector<bool>>& A, const vector<vector<bool>>& B,
+                                          PrefixTopology topology) {
+    vector<vector<bool>> Sums;
+    vector<bool> Carries;
+    bitSlicedEvaluate(A, B, false, [topology](const uint64_t* a, const uint64_t* b, uint64_t* sum, size_t width) {
+        return slicedPrefixAdd(a, b, sum, width, topology);
+    }, Sums, Carries);
+    appendFinalCarries(Sums, Carries);
+    return Sums;
+}
+
+//// Carry-Select and Carry-Skip Adders ////
+
+// Block size with the best ripple/select balance for a width, about sqrt(width)
+size_t defaultBlockSize(size_t width) {
+    return max<size_t>(1, (size_t)llround(sqrt((double)width)));
+}
+
+// Carry-select: the first block ripples; every later block ripples twice (carry-in 0 and 1) in parallel
+// and the incoming block carry selects between the two sums
+uint64_t slicedCarrySelectAdd(const uint64_t* A, const uint64_t* B, uint64_t* Sum, size_t width, size_t blockSize) {
+    blockSize = max<size_t>(1, blockSize); // A 0-bit block would never advance
+    uint64_t Carry = slicedRippleAdd(A, B, Sum, min(blockSize, width), false);
+    vector<uint64_t> sum0(blockSize), sum1(blockSize);
+
+    for (size_t start = blockSize; start < width; start += blockSize) {
+        size_t length = min(blockSize, width - start);
+        uint64_t carry0 = 0, carry1 = ~(uint64_t)0;
+        for (size_t j = 0; j < length; j++) {
+            slicedFullAdder(A[start + j], B[start + j], carry0, sum0[j], carry0);
+            slicedFullAdder(A[start + j], B[start + j], carry1, sum1[j], carry1);
+        }
+        for (size_t j = 0; j < length; j++) {
+            Sum[start + j] = (sum0[j] & ~Carry) | (sum1[j] & Carry); // 2:1 multiplexer
+        }
+        Carry = (carry0 & ~Carry) | (carry1 & Carry);
+    }
+    return Carry;
+}
+
+// Carry-skip: each block ripples its sums from the incoming carry, while the block carry-out is
+// G(block) + P(block)Cin, so a carry entering a fully propagating block skips straight past it
+uint64_t slicedCarrySkipAdd(const uint64_t* A, const uint64_t* B, uint64_t* Sum, size_t width, size_t blockSize) {
+    blockSize = max<size_t>(1, blockSize); // A 0-bit block would never advance
+    uint64_t Carry = 0;
+    for (size_t start = 0; start < width; start += blockSize) {
+        size_t length = min(blockSize, width - start);
+        uint64_t rippleCarry = Carry, blockGenerate = 0, blockPropagate = ~(uint64_t)0;
+        for (size_t j = start; j < start + length; j++) {
+            uint64_t Generate = A[j] & B[j], Propagate = A[j] ^ B[j];
+            slicedFullAdder(A[j], B[j], rippleCarry, Sum[j], rippleCarry);
+            blockGenerate = Generate | (Propagate & blockGenerate); // Block carry with carry-in 0
+            blockPropagate &= Propagate;
+        }
+        Carry = blockGenerate | (blockPropagate & Carry); // Skip path
+    }
+    return Carry;
+}
+
+vector<bool> carrySelectAdder(const vector<bool>& A, const vector<bool>& B, size_t blockSize) {
+    return singlePairSliced(A, B, [blockSize](const uint64_t* a, const uint64_t* b, uint64_t* sum, size_t width) {
+        return slicedCarrySelectAdd(a, b, sum, width, blockSize);
+    });
+}
+
+vector<bool> carrySkipAdder(const vector<bool>& A, const vector<bool>& B, size_t blockSize) {
+    return singlePairSliced(A, B, [blockSize](const uint64_t* a, const uint64_t* b, uint64_t* sum, size_t width) {
+        return slicedCarrySkipAdd(a, b, sum, width, blockSize);
+    });
+}
+
+//// Fast Adder ////
+vector<bool> fastAdder(const vector<bool>& A, const vector<bool>& B) {
+    size_t size = max(A.size(), B.size());
+    return carrySelectAdder(A, B, defaultBlockSize(size)); // Carry-select with sqrt(n) blocks
+}
+
+//// Adder Cost Model ////
+
+// Gate count and logical depth (2-input gates on the longest input-to-output path) of an adder
+struct AdderStats {
+    string name;
+    size_t width;
+    size_t gateCount;
+    size_t depth;
+};
+
+// One full-adder cell per bit (2 XOR, 2 AND, 1 OR), the carry passing serially from LSB to MSB.
+// parallelAdder computes S = (A XOR B) XOR Cin, C = AB + (A XOR B)Cin; carryLookaheadAdder
+// evaluates its recurrence serially as G/P, then S = P XOR C, C = G + PC. The two gate networks
+// are identical, so they share one cost model
+AdderStats serialCarryAdderStats(const string& name, size_t width) {
+    AdderStats stats = {name, width, 5 * width, 0};
+    size_t carryLevel = 0; // Carry-in is a constant
+    for (size_t i = 0; i < width; i++) {
+        size_t sumLevel = max<size_t>(1, carryLevel) + 1;
+        carryLevel = max<size_t>(1, max<size_t>(1, carryLevel) + 1) + 1;
+        stats.depth = max(stats.depth, max(sumLevel, carryLevel));
+    }
+    return stats;
+}
+
+AdderStats rippleAdderStats(size_t width) { return serialCarryAdderStats("Parallel (Ripple)", width); }
+
+AdderStats carryLookaheadAdderStats(size_t width) {
+    return serialCarryAdderStats("Carry Lookahead (Serial)", width);
+}
+
+// Parallel-prefix adders: G/P per bit, the prefix cells, then one XOR per sum bit. A cell whose
+// lower group already reaches bit 0 only needs G (gray cell, 2 gates); otherwise G and P (black cell, 3 gates)
+AdderStats prefixAdderStats(size_t width, PrefixTopology topology) {
+    AdderStats stats = {topologyName(topology), width, 2 * width + (width ? width - 1 : 0), width ? 1u : 0u};
+    vector<size_t> generateLevel(width, 1), propagateLevel(width, 1);
+    vector<bool> reachesLSB(width, false);
+    if (width) reachesLSB[0] = true;
+
+    walkPrefixNetwork(width, topology, [&](size_t i, size_t j) {
+        stats.gateCount += reachesLSB[j] ? 2 : 3;
+        generateLevel[i] = max(generateLevel[i], max(propagateLevel[i], generateLevel[j]) + 1) + 1;
+        if (!reachesLSB[j]) propagateLevel[i] = max(propagateLevel[i], propagateLevel[j]) + 1;
+        reachesLSB[i] = reachesLSB[j];
+    });
+
+    for (size_t j = 0; j < width; j++) {
+        size_t sumLevel = j ? max<size_t>(1, generateLevel[j - 1]) + 1 : 1;
+        stats.depth = max(stats.depth, max(sumLevel, generateLevel[j]));
+    }
+    return stats;
+}
+
+// Levels of a ripple chain of fullAdders fed by a carry arriving at carryLevel; returns the carry-out
+// level and raises depth to the latest sum or carry
+size_t rippleChainLevels(size_t length, size_t carryLevel, size_t& depth) {
+    for (size_t i = 0; i < length; i++) {
+        size_t sumLevel = max<size_t>(1, carryLevel) + 1;
+        carryLevel = max<size_t>(1, max<size_t>(1, carryLevel) + 1) + 1;
+        depth = max(depth, max(sumLevel, carryLevel));
+    }
+    return carryLevel;
+}
+
+// Carry-select: ripple first block, two fullAdder chains per later block, and a 2:1 multiplexer
+// (NOT, 2 AND, OR; the NOT is shared per block) per sum bit and block carry
+AdderStats carrySelectAdderStats(size_t width, size_t blockSize) {
+    blockSize = max<size_t>(1, blockSize); // A 0-bit block would never advance
+    AdderStats stats = {"Carry Select (b=" + to_string(blockSize) + ")", width, 0, 0};
+    size_t first = min(blockSize, width);
+    stats.gateCount = 5 * first;
+    size_t carryLevel = rippleChainLevels(first, 0, stats.depth);
+
+    for (size_t start = blockSize; start < width; start += blockSize) {
+        size_t length = min(blockSize, width - start);
+        size_t blockDepth = 0;
+        size_t chainCarry = rippleChainLevels(length, 0, blockDepth); // Both chains settle together
+        stats.gateCount += 10 * length + 3 * (length + 1) + 1;
+        size_t selectLevel = max(blockDepth + 1, carryLevel + 2) + 1; // Sums wait on the select line
+        stats.depth = max(stats.depth, selectLevel);
+        carryLevel = max(chainCarry + 1, carryLevel + 2) + 1;
+        stats.depth = max(stats.depth, carryLevel);
+    }
+    return stats;
+}
+
+// Carry-skip: fullAdder chain per block, a 2-gate block-generate chain beside it, an AND tree
+// for block propagate and the AND-OR skip stage
+AdderStats carrySkipAdderStats(size_t width, size_t blockSize) {
+    blockSize = max<size_t>(1, blockSize); // A 0-bit block would never advance
+    AdderStats stats = {"Carry Skip (b=" + to_string(blockSize) + ")", width, 0, 0};
+    size_t carryLevel = 0;
+    for (size_t start = 0; start < width; start += blockSize) {
+        size_t length = min(blockSize, width - start);
+        rippleChainLevels(length, carryLevel, stats.depth);
+        size_t unused = 0;
+        size_t generateLevel = rippleChainLevels(length, 0, unused); // Same AND-OR recurrence with carry-in 0
+        size_t propagateLevel = 1 + (size_t)ceil(log2((double)length));
+        stats.gateCount += 5 * length + 2 * length + (length - 1) + 2;
+        carryLevel = max(generateLevel, max(propagateLevel, carryLevel) + 1) + 1;
+        stats.depth = max(stats.depth, carryLevel);
+    }
+    return stats;
+}
+
+// Every adder in this file at one operand width, for picking an adder by latency
+vector<AdderStats> adderCostTable(size_t width) {
+    size_t blockSize = defaultBlockSize(width);
+    return {rippleAdderStats(width), carryLookaheadAdderStats(width), prefixAdderStats(width, KoggeStone),
+            prefixAdderStats(width, BrentKung), prefixAdderStats(width, Sklansky),
+            carrySelectAdderStats(width, blockSize), carrySkipAdderStats(width, blockSize)};
+}
+
+void printAdderCostTable(size_t width) {
+    cout << "\n--- Adder Cost at " << width << " Bits ---\n";
+    for (const AdderStats& stats : adderCostTable(width)) {
+        cout << stats.name << ": Gates = " << stats.gateCount << ", Depth = " << stats.depth << "\n";
+    }
+}
+
+//// Arbitrary-Precision Operands ////
+
+// Unsigned operand of any bit width in 64-bit limbs (limb 0 is least significant); bits above width stay 0
+struct WideOperand {
+    vector<uint64_t> limbs;
+    size_t width;
+    WideOperand(size_t width = 0) : limbs((width + 63) / 64, 0), width(width) {}
+};
+
+// One limb of a multi-word addition: Sum = A + B + Carry, returns the carry out
+inline unsigned char addWithCarry(unsigned char Carry, uint64_t A, uint64_t B, uint64_t& Sum) {
+#if defined(__x86_64__) || defined(_M_X64)
+    unsigned long long result;
+    Carry = _addcarry_u64(Carry, A, B, &result);
+    Sum = result;
+    return Carry;
+#else
+    uint64_t partial = A + B;
+    Sum = partial + Carry;
+    return (partial < A) | (Sum < partial);
+#endif
+}
+
+// Clear any bits above the operand's width in the top limb
+void maskToWidth(WideOperand& operand) {
+    if (operand.width % 64 && !operand.limbs.empty()) {
+        operand.limbs.back() &= ((uint64_t)1 << (operand.width % 64)) - 1;
+    }
+}
+
+// Shrink the width to the highest set bit (at least 1), as integerToBinary does for ints
+void trimWidth(WideOperand& operand) {
+    size_t width = operand.limbs.size() * 64;
+    while (width > 1 && !((operand.limbs[(width - 1) / 64] >> ((width - 1) % 64)) & 1)) width--;
+    operand.width = width;
+    operand.limbs.resize((width + 63) / 64);
+}
+
+// Read the limb at index i, treating missing limbs as zero
+inline uint64_t limbAt(const WideOperand& operand, size_t i) {
+    return i < operand.limbs.size() ? operand.limbs[i] : 0;
+}
+
+// Convert a binary number (MSB first) to a wide operand of the same width
+WideOperand binaryToWide(const vector<bool>& binary) {
+    WideOperand operand(binary.size());
+    size_t size = binary.size();
+    for (size_t j = 0; j < size; j++) {
+        if (binary[size - 1 - j]) operand.limbs[j / 64] |= (uint64_t)1 << (j % 64);
+    }
+    return operand;
+}
+
+// Convert a wide operand to a binary number (MSB first)
+vector<bool> wideToBinary(const WideOperand& operand) {
+    vector<bool> binary(operand.width);
+    for (size_t j = 0; j < operand.width; j++) {
+        binary[operand.width - 1 - j] = (operand.limbs[j / 64] >> (j % 64)) & 1;
+    }
+    return binary;
+}
+
+// Parse hexadecimal digits (no prefix) in O(n): each digit lands directly in its limb
+WideOperand hexToWide(const string& digits) {
+    WideOperand operand(max<size_t>(1, digits.size() * 4));
+    size_t position = 0;
+    for (size_t i = digits.size(); i-- > 0; position += 4) {
+        char c = digits[i];
+        uint64_t value = isdigit((unsigned char)c) ? c - '0' : (tolower((unsigned char)c) - 'a' + 10);
+        operand.limbs[position / 64] |= value << (position % 64);
+    }
+    trimWidth(operand);
+    return operand;
+}
+
+string wideToHex(const WideOperand& operand) {
+    static const char hexDigits[] = "0123456789abcdef";
+    string digits;
+    digits.reserve(operand.width / 4 + 1);
+    for (size_t position = 0; position < operand.width; position += 4) {
+        digits.push_back(hexDigits[(operand.limbs[position / 64] >> (position % 64)) & 0xF]);
+    }
+    while (digits.size() > 1 && digits.back() == '0') digits.pop_back();
+    if (digits.empty()) digits = "0";
+    reverse(digits.begin(), digits.end());
+    return digits;
+}
+
+// Parse decimal digits 19 at a time: operand = operand * 10^19 + chunk, one limb pass per chunk
+WideOperand decimalToWide(const string& digits) {
+    const uint64_t chunkBase = 10000000000000000000ULL; // 10^19
+    vector<uint64_t> limbs(1, 0);
+    size_t first = digits.size() % 19 ? digits.size() % 19 : 19;
+
+    for (size_t start = 0; start < digits.size(); start += (start ? 19 : first)) {
+        size_t length = start ? 19 : first;
+        uint64_t chunk = 0, scale = 1;
+        for (size_t i = start; i < start + length; i++) {
+            chunk = chunk * 10 + (digits[i] - '0');
+            scale *= 10;
+        }
+        unsigned __int128 carry = chunk;
+        for (uint64_t& limb : limbs) {
+            carry += (unsigned __int128)limb * (start ? chunkBase : scale);
+            limb = (uint64_t)carry;
+            carry >>= 64;
+        }
+        if (carry) limbs.push_back((uint64_t)carry);
+    }
+
+    WideOperand operand;
+    operand.limbs = limbs;
+    trimWidth(operand);
+    return operand;
+}
+
+// Print decimal by repeated division by 10^19, peeling 19 digits per limb pass
+string wideToDecimal(const WideOperand& operand) {
+    const uint64_t chunkBase = 10000000000000000000ULL; // 10^19
+    vector<uint64_t> limbs = operand.limbs;
+    while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+    if (limbs.empty()) return "0";
+
+    vector<uint64_t> chunks;
+    while (!limbs.empty()) {
+        unsigned __int128 remainder = 0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            remainder = (remainder << 64) | limbs[i];
+            limbs[i] = (uint64_t)(remainder / chunkBase);
+            remainder %= chunkBase;
+        }
+        chunks.push_back((uint64_t)remainder);
+        while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+    }
+
+    string digits = to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        string chunk = to_string(chunks[i]);
+        digits.append(19 - chunk.size(), '0');
+        digits += chunk;
+    }
+    return digits;
+}
+
+// Multi-word A + B (or A - B in Two's Complement at the operand width) on addWithCarry. Result's limb
+// storage is reused, so a caller looping over many operands does not allocate per addition
+void wideAddSubtract(const WideOperand& A, const WideOperand& B, bool subtract, WideOperand& Result) {
+    size_t size = max(A.width, B.width);
+    size_t limbCount = (size + 63) / 64;
+    Result.limbs.resize(limbCount);
+    Result.width = size;
+    unsigned char Carry = subtract; // Carry-in of 1 completes the Two's Complement of B
+    uint64_t invert = subtract ? ~(uint64_t)0 : 0;
+    for (size_t i = 0; i < limbCount; i++) {
+        Carry = addWithCarry(Carry, limbAt(A, i), limbAt(B, i) ^ invert, Result.limbs[i]);
+    }
+
+    if (subtract) {
+        maskToWidth(Result);
+    } else if (size % 64 == 0 ? Carry : (Result.limbs.back() >> (size % 64)) & 1) {
+        Result.width = size + 1; // Add final carry if needed
+        if (size % 64 == 0) Result.limbs.push_back(1);
+    }
+}
+
+WideOperand wideAddSubtract(const WideOperand& A, const WideOperand& B, bool subtract) {
+    WideOperand Result;
+    wideAddSubtract(A, B, subtract, Result);
+    return Result;
+}
+
+//// Addition/Subtraction Logic Unit (Wide) ////
+void additionSubtractionALU(const WideOperand& A, const WideOperand& B, bool mode, WideOperand& Result) {
+    wideAddSubtract(A, B, !mode, Result); // mode 1 adds, mode 0 subtracts
+}
+
+//// Fast Adder (Wide) ////
+WideOperand fastAdder(const WideOperand& A, const WideOperand& B) {
+    return wideAddSubtract(A, B, false);
+}
+
+//// Carry Lookahead Adder (Wide) ////
+// Generate/Propagate per limb: a limb generates when its 64-bit sum overflows and propagates
+// when the sum is all ones, so the carry recurrence runs once per limb instead of once per bit
+WideOperand carryLookaheadAdder(const WideOperand& A, const WideOperand& B) {
+    size_t size = max(A.width, B.width);
+    WideOperand Sum(size + 1);
+    uint64_t Carry = 0;
+    for (size_t i = 0; i < Sum.limbs.size(); i++) {
+        uint64_t a = limbAt(A, i), b = limbAt(B, i);
+        uint64_t partial = a + b;
+        uint64_t Generate = partial < a;
+        uint64_t Propagate = partial == ~(uint64_t)0;
+        Sum.limbs[i] = partial + Carry;
+        Carry = Generate | (Propagate & Carry); // C[i+1] = G[i] + P[i]C[i]
+    }
+    if (!((Sum.limbs[size / 64] >> (size % 64)) & 1)) {
+        Sum.width = size; // No final carry
+        Sum.limbs.resize((size + 63) / 64);
+    }
+    return Sum;
+}
+
+//// Adder Benchmark ////
+
+// One adder under test: a sliced kernel (run over pre-packed 64-lane operands) or a per-pair function
+struct BenchmarkAdder {
+    string name;
+    string layout;
+    AdderStats stats;
+    function<void(size_t)> run; // Adds every pair in the batch once; the argument is the pair count
+};
+
+// Seconds per call of run(pairs), repeating until at least minSeconds have elapsed
+double timeAdder(const function<void(size_t)>& run, size_t pairs, double minSeconds) {
+    size_t repetitions = 0;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        run(pairs);
+        repetitions++;
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed / repetitions;
+}
+
+// Run every adder in this file over random batches at widths 8..4096 and write one CSV row per
+// (adder, width): throughput, simulated gate delay/area, and speedup over the per-bit parallelAdder
+void runAdderBenchmark(ostream& csv, size_t pairs, const vector<size_t>& blockSizes, uint64_t seed = 1) {
+    csv << "adder,width,layout,adds_per_sec,gate_delay,gate_count,speedup_vs_parallel\n";
+    mt19937_64 generator(seed);
+    pairs = max(SLICE_LANES, (pairs + SLICE_LANES - 1) / SLICE_LANES * SLICE_LANES);
+    volatile uint64_t checksum = 0; // Keeps the optimizer from discarding results
+
+    for (size_t width = 8; width <= 4096; width *= 2) {
+        vector<vector<bool>> A(pairs, vector<bool>(width)), B(pairs, vector<bool>(width));
+        vector<WideOperand> wideA, wideB;
+        for (size_t k = 0; k < pairs; k++) {
+            for (size_t j = 0; j < width; j++) {
+                A[k][j] = generator() & 1;
+                B[k][j] = generator() & 1;
+            }
+            wideA.push_back(binaryToWide(A[k]));
+            wideB.push_back(binaryToWide(B[k]));
+        }
+        size_t groups = pairs / SLICE_LANES;
+        vector<vector<uint64_t>> slicedA, slicedB;
+        for (size_t g = 0; g < groups; g++) {
+            slicedA.push_back(packSlices(A, g * SLICE_LANES, SLICE_LANES, width));
+            slicedB.push_back(packSlices(B, g * SLICE_LANES, SLICE_LANES, width));
+        }
+        vector<uint64_t> slicedSum(width);
+
+        // Wrap a sliced kernel into a batch runner over the pre-packed groups
+        auto sliced = [&](function<uint64_t(const uint64_t*, const uint64_t*, uint64_t*, size_t)> kernel) {
+            return [&, kernel](size_t) {
+                for (size_t g = 0; g < groups; g++) {
+                    checksum = checksum + kernel(slicedA[g].data(), slicedB[g].data(), slicedSum.data(), width);
+                }
+            };
+        };
+        auto perPair = [&](function<vector<bool>(const vector<bool>&, const vector<bool>&)> adder) {
+            return [&, adder](size_t count) {
+                for (size_t k = 0; k < count; k++) checksum = checksum + adder(A[k], B[k]).size();
+            };
+        };
+
+        vector<BenchmarkAdder> adders = {
+            {"Parallel (Ripple)", "vector<bool>", rippleAdderStats(width), perPair(parallelAdder)},
+            {"Carry Lookahead (Serial)", "vector<bool>", carryLookaheadAdderStats(width),
+             perPair([](const vector<bool>& a, const vector<bool>& b) { return carryLookaheadAdder(a, b); })},
+            {"Bit-Sliced Ripple", "sliced", rippleAdderStats(width), sliced(slicedAddKernel)},
+            {"Bit-Sliced Carry Lookahead", "sliced", carryLookaheadAdderStats(width), sliced(slicedCarryLookaheadAdd)},
+        };
+        for (PrefixTopology topology : {KoggeStone, BrentKung, Sklansky}) {
+            adders.push_back({topologyName(topology), "sliced", prefixAdderStats(width, topology),
+                              sliced([topology](const uint64_t* a, const uint64_t* b, uint64_t* sum, size_t w) {
+                                  return slicedPrefixAdd(a, b, sum, w, topology);
+                              })});
+        }
+        vector<size_t> widthBlockSizes = blockSizes;
+        widthBlockSizes.push_back(defaultBlockSize(width));
+        sort(widthBlockSizes.begin(), widthBlockSizes.end());
+        widthBlockSizes.erase(unique(widthBlockSizes.begin(), widthBlockSizes.end()), widthBlockSizes.end());
+        for (size_t blockSize : widthBlockSizes) {
+            if (blockSize == 0 || blockSize > width) continue;
+            adders.push_back({"", "sliced", carrySelectAdderStats(width, blockSize),
+                              sliced([blockSize](const uint64_t* a, const uint64_t* b, uint64_t* sum, size_t w) {
+                                  return slicedCarrySelectAdd(a, b, sum, w, blockSize);
+                              })});
+            adders.push_back({"", "sliced", carrySkipAdderStats(width, blockSize),
+                              sliced([blockSize](const uint64_t* a, const uint64_t* b, uint64_t* sum, size_t w) {
+                                  return slicedCarrySkipAdd(a, b, sum, w, blockSize);
+                              })});
+        }
+        adders.push_back({"Wide Limb (addWithCarry)", "limbs", {"", width, 0, 0}, [&](size_t count) {
+            for (size_t k = 0; k < count; k++) checksum = checksum + fastAdder(wideA[k], wideB[k]).width;
+        }});
+
+        double baselineRate = 0;
+        for (BenchmarkAdder& adder : adders) {
+            if (adder.name.empty()) adder.name = adder.stats.name;
+            double seconds = timeAdder(adder.run, pairs, 0.02);
+            double rate = pairs / seconds;
+            if (baselineRate == 0) baselineRate = rate; // parallelAdder comes first
+            csv << adder.name << "," << width << "," << adder.layout << "," << (uint64_t)rate << ",";
+            if (adder.stats.gateCount) csv << adder.stats.depth << "," << adder.stats.gateCount;
+            else csv << ","; // No gate model for the machine-word adder
+            csv << "," << rate / baselineRate << "\n";
+        }
+    }
+}
+
+//// Batch Mode ////
+
+// Parse one decimal or 0x-prefixed hex token into a reused operand; operands that fit one limb
+// skip the general parsers. Returns false on a malformed token
+bool parseWideToken(const char* begin, const char* end, WideOperand& operand) {
+    bool hex = end - begin > 2 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X');
+    if (hex) begin += 2;
+    if (begin == end) return false;
+    for (const char* c = begin; c != end; c++) {
+        if (hex ? !isxdigit((unsigned char)*c) : !isdigit((unsigned char)*c)) return false;
+    }
+
+    if (end - begin <= (hex ? 16 : 19)) {
+        uint64_t value = 0;
+        for (const char* c = begin; c != end; c++) {
+            value = hex ? (value << 4) | (isdigit((unsigned char)*c) ? *c - '0' : (tolower((unsigned char)*c) - 'a' + 10))
+                        : value * 10 + (*c - '0');
+        }
+        operand.limbs.assign(1, value);
+        operand.width = 64;
+        trimWidth(operand);
+    } else {
+        string digits(begin, end);
+        operand = hex ? hexToWide(digits) : decimalToWide(digits);
+    }
+    return true;
+}
+
+// Parse a decimal operand, or a hexadecimal one with a 0x prefix. Returns false on a malformed operand
+bool parseWide(const string& text, WideOperand& operand) {
+    return parseWideToken(text.data(), text.data() + text.size(), operand);
+}
+
+// Append an operand in decimal, without a temporary string when it fits one limb
+void appendDecimal(const WideOperand& operand, string& out) {
+    if (operand.width <= 64) {
+        char digits[24];
+        int length = snprintf(digits, sizeof(digits), "%llu", (unsigned long long)limbAt(operand, 0));
+        out.append(digits, length);
+    } else {
+        out += wideToDecimal(operand);
+    }
+}
+
+// Evaluate every "A B mode" line of [begin, end) through additionSubtractionALU, appending one
+// decimal result per line ("error" for a malformed line) to out
+void runBatchChunk(const char* begin, const char* end, string& out) {
+    WideOperand A, B, Result; // Reused across lines
+    const char* line = begin;
+    while (line < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(line, '\n', end - line));
+        if (!lineEnd) lineEnd = end;
+
+        const char* tokens[3][2];
+        int count = 0;
+        for (const char* c = line; c < lineEnd && count < 4;) {
+            while (c < lineEnd && isspace((unsigned char)*c)) c++;
+            if (c == lineEnd) break;
+            const char* tokenStart = c;
+            while (c < lineEnd && !isspace((unsigned char)*c)) c++;
+            if (count < 3) {
+                tokens[count][0] = tokenStart;
+                tokens[count][1] = c;
+            }
+            count++;
+        }
+
+        if (count == 0) {
+            // Blank line: no record
+        } else if (count != 3 || tokens[2][1] - tokens[2][0] != 1 || (*tokens[2][0] != '0' && *tokens[2][0] != '1') ||
+                   !parseWideToken(tokens[0][0], tokens[0][1], A) || !parseWideToken(tokens[1][0], tokens[1][1], B)) {
+            out += "error\n";
+        } else {
+            additionSubtractionALU(A, B, *tokens[2][0] == '1', Result);
+            appendDecimal(Result, out);
+            out += '\n';
+        }
+        line = lineEnd + 1;
+    }
+}
+
+// Batch ALU: memory-maps inputPath, splits it into newline-aligned chunks processed by a pool of
+// worker threads, and writes each chunk's results in input order through one buffered writer
+bool runBatchALU(const string& inputPath, const string& outputPath, size_t threadCount) {
+    MappedFile input;
+    if (!input.open(inputPath)) {
+        cout << "Error: Unable to open " << inputPath << endl;
+        return false;
+    }
+    ofstream output(outputPath, ios::binary);
+    if (!output) {
+        cout << "Error: Unable to open " << outputPath << endl;
+        return false;
+    }
+
+    // Newline-aligned chunk boundaries
+    const size_t chunkBytes = 1 << 20;
+    vector<size_t> boundaries = {0};
+    while (boundaries.back() < input.size) {
+        size_t next = min(input.size, boundaries.back() + chunkBytes);
+        const char* newline = next < input.size ? static_cast<const char*>(
+            memchr(input.data + next, '\n', input.size - next)) : nullptr;
+        boundaries.push_back(newline ? newline - input.data + 1 : input.size);
+    }
+    size_t chunkCount = boundaries.size() - 1;
+
+    vector<string> results(chunkCount);
+    vector<bool> done(chunkCount, false);
+    atomic<size_t> nextChunk(0);
+    mutex doneMutex;
+    condition_variable chunkDone;
+
+    auto worker = [&]() {
+        for (size_t chunk; (chunk = nextChunk++) < chunkCount;) {
+            string out;
+            out.reserve(boundaries[chunk + 1] - boundaries[chunk]);
+            runBatchChunk(input.data + boundaries[chunk], input.data + boundaries[chunk + 1], out);
+            lock_guard<mutex> lock(doneMutex);
+            results[chunk] = move(out);
+            done[chunk] = true;
+            chunkDone.notify_one();
+        }
+    };
+
+    vector<thread> pool;
+    for (size_t i = 0; i < max<size_t>(1, threadCount); i++) pool.emplace_back(worker);
+
+    // Writer: drain finished chunks in order while the workers keep going
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        string out;
+        {
+            unique_lock<mutex> lock(doneMutex);
+            chunkDone.wait(lock, [&]() { return done[chunk]; });
+            out = move(results[chunk]);
+        }
+        output.write(out.data(), out.size());
+    }
+
+    for (thread& t : pool) t.join();
+    return bool(output);
+}
+
+//// Gate-Level Timing Simulator ////
+
+enum GateType {
+    AndGate,
+    OrGate,
+    XorGate,
+    NotGate
+};
+
+// Propagation delay of each gate type, in simulator time units
+struct GateDelays {
+    uint32_t andDelay = 1;
+    uint32_t orDelay = 1;
+    uint32_t xorDelay = 2;
+    uint32_t notDelay = 1;
+
+    uint32_t of(GateType type) const {
+        switch (type) {
+        case AndGate: return andDelay;
+        case OrGate: return orDelay;
+        case XorGate: return xorDelay;
+        case NotGate: return notDelay;
+        }
+        return 0;
+    }
+};
+
+struct Gate {
+    GateType type;
+    uint32_t inputs[2]; // NOT uses inputs[0]
+    uint32_t output;
+    uint32_t delay;
+};
+
+// Gates in creation order, which is also a topological order since a gate can only read existing nets.
+// Nets 0 and 1 are the constants 0 and 1
+class Netlist {
+public:
+    string name;
+    vector<Gate> gates;
+    uint32_t netCount = 2;
+    vector<uint32_t> inputA, inputB; // Primary inputs, LSB first
+    vector<uint32_t> outputs;        // Sum bits LSB first, then the final carry
+    vector<uint32_t> fanoutStart, fanoutGates; // Gates reading each net, as offsets into fanoutGates
+    GateDelays delays;
+
+    static constexpr uint32_t ZERO = 0, ONE = 1;
+
+    Netlist(const string& name, size_t width, GateDelays delays = GateDelays()) : name(name), delays(delays) {
+        for (size_t i = 0; i < width; i++) inputA.push_back(netCount++);
+        for (size_t i = 0; i < width; i++) inputB.push_back(netCount++);
+    }
+
+    uint32_t addGate(GateType type, uint32_t a, uint32_t b = ZERO) {
+        gates.push_back({type, {a, b}, netCount, delays.of(type)});
+        return netCount++;
+    }
+
+    uint32_t AND(uint32_t a, uint32_t b) { return addGate(AndGate, a, b); }
+    uint32_t OR(uint32_t a, uint32_t b) { return addGate(OrGate, a, b); }
+    uint32_t XOR(uint32_t a, uint32_t b) { return addGate(XorGate, a, b); }
+    uint32_t NOT(uint32_t a) { return addGate(NotGate, a); }
+
+    // The halfAdder and fullAdder gates
+    void halfAdder(uint32_t A, uint32_t B, uint32_t& Sum, uint32_t& Carry) {
+        Sum = XOR(A, B);
+        Carry = AND(A, B);
+    }
+
+    void fullAdder(uint32_t A, uint32_t B, uint32_t Cin, uint32_t& Sum, uint32_t& Carry) {
+        uint32_t intermediateSum, intermediateCarry1, intermediateCarry2;
+        halfAdder(A, B, intermediateSum, intermediateCarry1);
+        halfAdder(intermediateSum, Cin, Sum, intermediateCarry2);
+        Carry = OR(intermediateCarry1, intermediateCarry2);
+    }
+
+    // 2:1 multiplexer, select ? b : a
+    uint32_t MUX(uint32_t a, uint32_t b, uint32_t select, uint32_t notSelect) {
+        return OR(AND(a, notSelect), AND(b, select));
+    }
+
+    void buildFanout() {
+        fanoutStart.assign(netCount + 1, 0);
+        for (const Gate& gate : gates) {
+            fanoutStart[gate.inputs[0] + 1]++;
+            if (gate.type != NotGate && gate.inputs[1] != gate.inputs[0]) fanoutStart[gate.inputs[1] + 1]++;
+        }
+        for (uint32_t net = 0; net < netCount; net++) fanoutStart[net + 1] += fanoutStart[net];
+        fanoutGates.resize(fanoutStart[netCount]);
+        vector<uint32_t> fill(fanoutStart.begin(), fanoutStart.end() - 1);
+        for (uint32_t g = 0; g < gates.size(); g++) {
+            fanoutGates[fill[gates[g].inputs[0]]++] = g;
+            if (gates[g].type != NotGate && gates[g].inputs[1] != gates[g].inputs[0]) fanoutGates[fill[gates[g].inputs[1]]++] = g;
+        }
+    }
+};
+
+inline bool evaluateGate(const Gate& gate, const vector<uint8_t>& value) {
+    bool a = value[gate.inputs[0]], b = value[gate.inputs[1]];
+    switch (gate.type) {
+    case AndGate: return a & b;
+    case OrGate: return a | b;
+    case XorGate: return a ^ b;
+    case NotGate: return !a;
+    }
+    return 0;
+}
+
+//// Adder Netlists ////
+
+// parallelAdder: a chain of fullAdders
+Netlist buildRippleNetlist(size_t width, GateDelays delays = GateDelays()) {
+    Netlist netlist("Parallel (Ripple)", width, delays);
+    uint32_t Carry = Netlist::ZERO;
+    for (size_t i = 0; i < width; i++) {
+        uint32_t Sum;
+        netlist.fullAdder(netlist.inputA[i], netlist.inputB[i], Carry, Sum, Carry);
+        netlist.outputs.push_back(Sum);
+    }
+    netlist.outputs.push_back(Carry);
+    netlist.buildFanout();
+    return netlist;
+}
+
+// carryLookaheadAdder: G/P per bit and the serial carry recurrence
+Netlist buildCarryLookaheadNetlist(size_t width, GateDelays delays = GateDelays()) {
+    Netlist netlist("Carry Lookahead (Serial)", width, delays);
+    uint32_t Carry = Netlist::ZERO;
+    for (size_t i = 0; i < width; i++) {
+        uint32_t Generate = netlist.AND(netlist.inputA[i], netlist.inputB[i]);
+        uint32_t Propagate = netlist.XOR(netlist.inputA[i], netlist.inputB[i]);
+        netlist.outputs.push_back(netlist.XOR(Propagate, Carry));
+        Carry = netlist.OR(Generate, netlist.AND(Propagate, Carry));
+    }
+    netlist.outputs.push_back(Carry);
+    netlist.buildFanout();
+    return netlist;
+}
+
+// Parallel-prefix adders, wired by the same walkPrefixNetwork as slicedPrefixAdd
+Netlist buildPrefixNetlist(size_t width, PrefixTopology topology, GateDelays delays = GateDelays()) {
+    Netlist netlist(topologyName(topology), width, delays);
+    vector<uint32_t> Generate(width), Propagate(width), HalfSum(width);
+    vector<bool> reachesLSB(width, false);
+    for (size_t j = 0; j < width; j++) {
+        Generate[j] = netlist.AND(netlist.inputA[j], netlist.inputB[j]);
+        Propagate[j] = HalfSum[j] = netlist.XOR(netlist.inputA[j], netlist.inputB[j]);
+    }
+    if (width) reachesLSB[0] = true;
+
+    walkPrefixNetwork(width, topology, [&](size_t i, size_t j) {
+        Generate[i] = netlist.OR(Generate[i], netlist.AND(Propagate[i], Generate[j]));
+        if (!reachesLSB[j]) Propagate[i] = netlist.AND(Propagate[i], Propagate[j]); // Gray cells skip P
+        reachesLSB[i] = reachesLSB[j];
+    });
+
+    for (size_t j = 0; j < width; j++) {
+        netlist.outputs.push_back(j ? netlist.XOR(HalfSum[j], Generate[j - 1]) : HalfSum[0]);
+    }
+    netlist.outputs.push_back(width ? Generate[width - 1] : Netlist::ZERO);
+    netlist.buildFanout();
+    return netlist;
+}
+
+// slicedCarrySelectAdd: ripple first block, two chains and multiplexers for the rest
+Netlist buildCarrySelectNetlist(size_t width, size_t blockSize, GateDelays delays = GateDelays()) {
+    blockSize = max<size_t>(1, blockSize); // A 0-bit block would never advance
+    Netlist netlist("Carry Select (b=" + to_string(blockSize) + ")", width, delays);
+    uint32_t Carry = Netlist::ZERO;
+    for (size_t start = 0; start < width; start += blockSize) {
+        size_t length = min(blockSize, width - start);
+        if (start == 0) {
+            for (size_t j = 0; j < length; j++) {
+                uint32_t Sum;
+                netlist.fullAdder(netlist.inputA[j], netlist.inputB[j], Carry, Sum, Carry);
+                netlist.outputs.push_back(Sum);
+            }
+            continue;
+        }
+        uint32_t carry0 = Netlist::ZERO, carry1 = Netlist::ONE;
+        vector<uint32_t> sum0(length), sum1(length);
+        for (size_t j = 0; j < length; j++) {
+            netlist.fullAdder(netlist.inputA[start + j], netlist.inputB[start + j], carry0, sum0[j], carry0);
+            netlist.fullAdder(netlist.inputA[start + j], netlist.inputB[start + j], carry1, sum1[j], carry1);
+        }
+        uint32_t notCarry = netlist.NOT(Carry);
+        for (size_t j = 0; j < length; j++) netlist.outputs.push_back(netlist.MUX(sum0[j], sum1[j], Carry, notCarry));
+        Carry = netlist.MUX(carry0, carry1, Carry, notCarry);
+    }
+    netlist.outputs.push_back(Carry);
+    netlist.buildFanout();
+    return netlist;
+}
+
+// slicedCarrySkipAdd: fullAdder chain per block plus block generate/propagate and the skip stage
+Netlist buildCarrySkipNetlist(size_t width, size_t blockSize, GateDelays delays = GateDelays()) {
+    blockSize = max<size_t>(1, blockSize); // A 0-bit block would never advance
+    Netlist netlist("Carry Skip (b=" + to_string(blockSize) + ")", width, delays);
+    uint32_t Carry = Netlist::ZERO;
+    for (size_t start = 0; start < width; start += blockSize) {
+        size_t length = min(blockSize, width - start);
+        uint32_t rippleCarry = Carry, blockGenerate = Netlist::ZERO;
+        vector<uint32_t> propagates;
+        for (size_t j = start; j < start + length; j++) {
+            uint32_t Propagate, Generate, Sum, secondCarry;
+            netlist.halfAdder(netlist.inputA[j], netlist.inputB[j], Propagate, Generate);
+            netlist.halfAdder(Propagate, rippleCarry, Sum, secondCarry);
+            rippleCarry = netlist.OR(Generate, secondCarry);
+            netlist.outputs.push_back(Sum);
+            blockGenerate = j == start ? Generate : netlist.OR(Generate, netlist.AND(Propagate, blockGenerate));
+            propagates.push_back(Propagate);
+        }
+        while (propagates.size() > 1) { // Balanced AND tree for the block propagate
+            vector<uint32_t> next;
+            for (size_t k = 0; k + 1 < propagates.size(); k += 2) next.push_back(netlist.AND(propagates[k], propagates[k + 1]));
+            if (propagates.size() % 2) next.push_back(propagates.back());
+            propagates = next;
+        }
+        Carry = netlist.OR(blockGenerate, netlist.AND(propagates[0], Carry));
+    }
+    netlist.outputs.push_back(Carry);
+    netlist.buildFanout();
+    return netlist;
+}
+
+// Netlists for every adder in this file at one width
+vector<Netlist> buildAdderNetlists(size_t width, GateDelays delays = GateDelays()) {
+    size_t blockSize = defaultBlockSize(width);
+    vector<Netlist> netlists;
+    netlists.push_back(buildRippleNetlist(width, delays));
+    netlists.push_back(buildCarryLookaheadNetlist(width, delays));
+    for (PrefixTopology topology : {KoggeStone, BrentKung, Sklansky}) netlists.push_back(buildPrefixNetlist(width, topology, delays));
+    netlists.push_back(buildCarrySelectNetlist(width, blockSize, delays));
+    netlists.push_back(buildCarrySkipNetlist(width, blockSize, delays));
+    return netlists;
+}
+
+//// Event-Driven Simulation ////
+
+struct TimingReport {
+    uint64_t settleTime = 0;      // Time of the last net transition
+    uint64_t events = 0;          // Scheduled output updates processed
+    uint64_t transitions = 0;     // Net value changes
+    uint64_t glitches = 0;        // Transitions beyond the one (or none) each net needs to reach its final value
+    uint64_t outputGlitches = 0;  // The same, counted on the adder outputs only
+    uint64_t criticalPathDelay = 0;       // Worst-case (static) longest input-to-output delay
+    vector<uint32_t> criticalPath;        // Gates along it, input side first
+};
+
+// Static timing: latest arrival over all input-to-output paths, traced back through the slowest inputs
+void analyzeCriticalPath(const Netlist& netlist, TimingReport& report) {
+    vector<uint64_t> arrival(netlist.netCount, 0);
+    vector<int64_t> driver(netlist.netCount, -1);
+    for (uint32_t g = 0; g < netlist.gates.size(); g++) {
+        const Gate& gate = netlist.gates[g];
+        uint32_t slowest = gate.inputs[0];
+        if (gate.type != NotGate && arrival[gate.inputs[1]] > arrival[slowest]) slowest = gate.inputs[1];
+        arrival[gate.output] = arrival[slowest] + gate.delay;
+        driver[gate.output] = g;
+    }
+
+    uint32_t end = netlist.outputs.empty() ? 0 : netlist.outputs[0];
+    for (uint32_t net : netlist.outputs) {
+        if (arrival[net] > arrival[end]) end = net;
+    }
+    report.criticalPathDelay = arrival[end];
+    report.criticalPath.clear();
+    for (int64_t g = driver[end]; g >= 0;) {
+        report.criticalPath.push_back(g);
+        const Gate& gate = netlist.gates[g];
+        uint32_t slowest = gate.inputs[0];
+        if (gate.type != NotGate && arrival[gate.inputs[1]] > arrival[slowest]) slowest = gate.inputs[1];
+        g = driver[slowest];
+    }
+    reverse(report.criticalPath.begin(), report.criticalPath.end());
+}
+
+// Event-driven simulator with a timing wheel: every gate delay fits in the wheel, so scheduling and
+// retrieving an event are O(1). Delays are transport delays, so glitches propagate
+class TimingSimulator {
+private:
+    struct Event {
+        uint32_t net;
+        uint8_t value;
+    };
+
+    const Netlist& netlist;
+    vector<uint8_t> value;
+    vector<uint32_t> toggles;
+    vector<uint64_t> evaluatedAt; // Time + 1 of each gate's last evaluation, to evaluate once per time step
+    vector<vector<Event>> wheel;
+    vector<uint32_t> changed;
+
+    void setInputs(const vector<bool>& A, const vector<bool>& B, vector<Event>& events) {
+        // Binary numbers are MSB first; netlist inputs are LSB first
+        for (size_t i = 0; i < netlist.inputA.size(); i++) {
+            events.push_back({netlist.inputA[i], (uint8_t)(i < A.size() && A[A.size() - 1 - i])});
+            events.push_back({netlist.inputB[i], (uint8_t)(i < B.size() && B[B.size() - 1 - i])});
+        }
+    }
+
+public:
+    TimingSimulator(const Netlist& netlist) : netlist(netlist) {
+        uint32_t maxDelay = 1;
+        for (const Gate& gate : netlist.gates) maxDelay = max(maxDelay, gate.delay);
+        wheel.resize(max<uint32_t>(1, maxDelay) + 1);
+    }
+
+    // Settle the netlist on (fromA, fromB), then switch the inputs to (toA, toB) at time 0 and
+    // simulate until no events remain
+    TimingReport simulate(const vector<bool>& fromA, const vector<bool>& fromB,
+                          const vector<bool>& toA, const vector<bool>& toB) {
+        TimingReport report;
+        value.assign(netlist.netCount, 0);
+        value[Netlist::ONE] = 1;
+        vector<Event> events;
+        setInputs(fromA, fromB, events);
+        for (const Event& event : events) value[event.net] = event.value;
+        for (const Gate& gate : netlist.gates) value[gate.output] = evaluateGate(gate, value); // Topological order
+        vector<uint8_t> initial = value;
+
+        toggles.assign(netlist.netCount, 0);
+        evaluatedAt.assign(netlist.gates.size(), 0);
+        events.clear();
+        setInputs(toA, toB, events);
+        wheel[0] = events;
+        size_t pending = events.size();
+
+        for (uint64_t time = 0; pending > 0; time++) {
+            vector<Event>& slot = wheel[time % wheel.size()];
+            pending -= slot.size();
+            report.events += slot.size();
+            changed.clear();
+            for (const Event& event : slot) {
+                if (value[event.net] == event.value) continue;
+                value[event.net] = event.value;
+                toggles[event.net]++;
+                report.transitions++;
+                report.settleTime = time;
+                changed.push_back(event.net);
+            }
+            slot.clear();
+
+            for (uint32_t net : changed) {
+                for (uint32_t k = netlist.fanoutStart[net]; k < netlist.fanoutStart[net + 1]; k++) {
+                    uint32_t g = netlist.fanoutGates[k];
+                    if (evaluatedAt[g] == time + 1) continue;
+                    evaluatedAt[g] = time + 1;
+                    const Gate& gate = netlist.gates[g];
+                    // A 0-delay gate settles in the next slot: this one has already been drained
+                    uint64_t at = time + max<uint32_t>(1, gate.delay);
+                    wheel[at % wheel.size()].push_back({gate.output, evaluateGate(gate, value)});
+                    pending++;
+                }
+            }
+        }
+
+        for (uint32_t net = 0; net < netlist.netCount; net++) {
+            uint64_t extra = toggles[net] - (value[net] != initial[net]);
+            report.glitches += extra;
+        }
+        for (uint32_t net : netlist.outputs) report.outputGlitches += toggles[net] - (value[net] != initial[net]);
+        analyzeCriticalPath(netlist, report);
+        return report;
+    }
+
+    // Adder outputs after the last simulate(), as a binary number in parallelAdder's format
+    vector<bool> result() const {
+        size_t width = netlist.inputA.size();
+        bool Carry = value[netlist.outputs[width]];
+        vector<bool> Sum(width + Carry);
+        if (Carry) Sum[0] = 1;
+        for (size_t i = 0; i < width; i++) Sum[Sum.size() - 1 - i] = value[netlist.outputs[i]];
+        return Sum;
+    }
+};
+
+// Simulate random input transitions on every adder at one width and print the timing of each
+void printTimingReport(size_t width, size_t vectors, GateDelays delays = GateDelays(), uint64_t seed = 1) {
+    mt19937_64 generator(seed);
+    vector<vector<bool>> operands(vectors * 2 + 2, vector<bool>(width));
+    for (vector<bool>& operand : operands) {
+        for (size_t j = 0; j < width; j++) operand[j] = generator() & 1;
+    }
+
+    cout << "\n--- Timing at " << width << " Bits (" << vectors << " random transitions) ---\n";
+    for (const Netlist& netlist : buildAdderNetlists(width, delays)) {
+        TimingSimulator simulator(netlist);
+        uint64_t worstSettle = 0, glitches = 0, outputGlitches = 0, events = 0;
+        TimingReport report;
+        auto start = chrono::steady_clock::now();
+        for (size_t v = 0; v < vectors; v++) {
+            report = simulator.simulate(operands[2 * v], operands[2 * v + 1], operands[2 * v + 2], operands[2 * v + 3]);
+            worstSettle = max(worstSettle, report.settleTime);
+            glitches += report.glitches;
+            outputGlitches += report.outputGlitches;
+            events += report.events;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout << netlist.name << ": Gates = " << netlist.gates.size()
+             << ", Critical Path = " << report.criticalPathDelay << " (" << report.criticalPath.size() << " gates)"
+             << ", Worst Settle Time = " << worstSettle
+             << ", Glitches/Vector = " << glitches / vectors << " (" << outputGlitches / vectors << " on outputs)"
+             << ", Events/s = " << (uint64_t)(events / max(seconds, 1e-9)) << "\n";
+    }
+}
+
+// Parse a whole command-line argument as an unsigned integer in [low, high]; no sign or blanks
+bool parseCountArgument(const char* text, size_t low, size_t high, size_t& value) {
+    if (!isdigit((unsigned char)text[0])) return false;
+    errno = 0;
+    char* end;
+    unsigned long long parsed = strtoull(text, &end, 10);
+    if (errno || *end || parsed < low || parsed > high) return false;
+    value = parsed;
+    return true;
+}
+
 //// Main Function ////
-int main() {
-    int input1, input2;
+int main(int argc, char* argv[]) {
+    // Benchmark mode: Adder --bench [output.csv] [block sizes...]
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        vector<size_t> blockSizes = {4, 16};
+        if (argc > 3) {
+            blockSizes.clear();
+            for (int i = 3; i < argc; i++) {
+                size_t blockSize;
+                if (!parseCountArgument(argv[i], 1, 1 << 20, blockSize)) {
+                    cout << "Error: Block sizes must be integers from 1 to " << (1 << 20) << ": " << argv[i] << endl;
+                    cout << "Usage: Adder --bench [output.csv] [block sizes...]" << endl;
+                    return 1;
+                }
+                blockSizes.push_back(blockSize);
+            }
+        }
+        if (argc > 2) {
+            ofstream csv(argv[2]);
+            if (!csv) {
+                cout << "Error: Unable to open " << argv[2] << endl;
+                return 1;
+            }
+            runAdderBenchmark(csv, 256, blockSizes);
+        } else {
+            runAdderBenchmark(cout, 256, blockSizes);
+        }
+        return 0;
+    }
+
+    // Timing mode: Adder --timing width [transitions]
+    if (argc > 2 && string(argv[1]) == "--timing") {
+        size_t width, vectors = 16;
+        if (!parseCountArgument(argv[2], 1, 1 << 16, width) ||
+            (argc > 3 && !parseCountArgument(argv[3], 1, 1 << 24, vectors))) {
+            cout << "Error: Width must be from 1 to " << (1 << 16) << " and transitions from 1 to " << (1 << 24) << endl;
+            cout << "Usage: Adder --timing width [transitions]" << endl;
+            return 1;
+        }
+        printTimingReport(width, vectors);
+        return 0;
+    }
+
+    // Batch mode: Adder --batch input.txt output.txt [threads], one "A B mode" record per line
+    if (argc > 3 && string(argv[1]) == "--batch") {
+        size_t threadCount = max(1u, thread::hardware_concurrency());
+        if (argc > 4 && !parseCountArgument(argv[4], 1, 4096, threadCount)) {
+            cout << "Error: Thread count must be from 1 to 4096: " << argv[4] << endl;
+            cout << "Usage: Adder --batch input.txt output.txt [threads]" << endl;
+            return 1;
+        }
+        return runBatchALU(argv[2], argv[3], threadCount) ? 0 : 1;
+    }
+
+    string text1, text2;
     bool mode;
 
     // Take inputs from the user
-    cout << "Enter the first integer: ";
-    cin >> input1;
-    cout << "Enter the second integer: ";
-    cin >> input2;
+    cout << "Enter the first integer (decimal, or hex with 0x): ";
+    cin >> text1;
+    cout << "Enter the second integer (decimal, or hex with 0x): ";
+    cin >> text2;
     cout << "Enter mode (1 for Addition, 0 for Subtraction): ";
     cin >> mode;
 
+    WideOperand wide1, wide2;
+    if (!parseWide(text1, wide1) || !parseWide(text2, wide2)) {
+        cout << "Error: Operands must be non-negative decimal or 0x-prefixed hex integers" << endl;
+        return 1;
+    }
+
+    // Operands beyond int range go through the limb-based ALU
+    if (wide1.width > 31 || wide2.width > 31) {
+        WideOperand wideResult;
+        additionSubtractionALU(wide1, wide2, mode, wideResult);
+        cout << (mode ? "\nAddition Result (Hex): 0x" : "\nSubtraction Result (Hex): 0x") << wideToHex(wideResult);
+        cout << "\nResult (Decimal): " << wideToDecimal(wideResult) << "\n";
+
+        wideResult = carryLookaheadAdder(wide1, wide2);
+        cout << "\nCarry Lookahead Adder Result (Hex): 0x" << wideToHex(wideResult);
+        cout << "\nResult (Decimal): " << wideToDecimal(wideResult) << "\n";
+        return 0;
+    }
+    int input1 = (int)wide1.limbs[0], input2 = (int)wide2.limbs[0];
+
     // Convert integers to binary
     vector<bool> binary1 = integerToBinary(input1);
     vector<bool> binary2 = integerToBinary(input2);
@@ -173,6 +1696,20 @@ int main() {
 
     cout << "\nResult (Decimal): " << binaryToInteger(result) << "\n";
 
+    // Carry-Select and Carry-Skip Adder Examples
+    size_t blockSize = defaultBlockSize(max(binary1.size(), binary2.size()));
+    result = carrySelectAdder(binary1, binary2, blockSize);
+    cout << "\nCarry Select Adder Result (Binary): ";
+    for (bool bit : result) cout << bit;
+
+    cout << "\nResult (Decimal): " << binaryToInteger(result) << "\n";
+
+    result = carrySkipAdder(binary1, binary2, blockSize);
+    cout << "\nCarry Skip Adder Result (Binary): ";
+    for (bool bit : result) cout << bit;
+
+    cout << "\nResult (Decimal): " << binaryToInteger(result) << "\n";
+
     // Carry Lookahead Adder Example
     result = carryLookaheadAdder(binary1, binary2);
     cout << "\nCarry Lookahead Adder Result (Binary): ";
@@ -180,5 +1717,18 @@ int main() {
 
     cout << "\nResult (Decimal): " << binaryToInteger(result) << "\n";
 
+    // Parallel-Prefix Adder Examples
+    for (PrefixTopology topology : {KoggeStone, BrentKung, Sklansky}) {
+        result = parallelPrefixAdder(binary1, binary2, topology);
+        cout << "\n" << topologyName(topology) << " Adder Result (Binary): ";
+        for (bool bit : result) cout << bit;
+
+        cout << "\nResult (Decimal): " << binaryToInteger(result) << "\n";
+    }
+
+    // Gate count and logical depth of each adder, at this width and at wide-word widths
+    printAdderCostTable(max(binary1.size(), binary2.size()));
+    for (size_t width : {256, 1024, 4096}) printAdderCostTable(width);
+
     return 0;
 }
@@ -1,139 +1,560 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <thread>
+#include <functional>
+#include "DifferentialVerifier.h"
+#include "PackedRegister.h"
 
 using namespace std;
 
-//// Helper Functions ////
+//// Booth Registers ////
 
-// Convert an integer to binary (Two's Complement for negative numbers)
-vector<bool> integerToBinary(int number, int bitWidth) {
-    vector<bool> binary(bitWidth, 0); // Initialize with 0s
-    bool isNegative = (number < 0);  // Check if the number is negative
+// A:Q:Q(-1) as one register pair: the low half is Q:Q(-1) (Q(-1) is bit 0) and the high half is A
+// with a guard sign bit above it, so A - M cannot overflow when M is the most negative value
+struct BoothRegisters {
+    RegisterPair AQ;
+    size_t bitWidth;
+    BoothRegisters(size_t bitWidth) : AQ(bitWidth + 1, bitWidth + 1), bitWidth(bitWidth) {}
 
-    // Convert to binary (absolute value)
-    number = abs(number);
-    for (int i = bitWidth - 1; i >= 0; i--) {
-        binary[i] = number % 2;
-        number /= 2;
+    PackedRegister A() const { return extractPacked(AQ.bits, bitWidth + 1, bitWidth); }
+    PackedRegister Q() const { return extractPacked(AQ.bits, 1, bitWidth); }
+    bool QMinus1() const { return AQ.bits.bit(0); }
+};
+
+//// Step Trace Observers ////
+
+// boothsAlgorithm reports its registers through a trace observer chosen at compile time. Observers
+// get the registers by reference, so only an observer that records them pays for anything
+
+// No tracing: both hooks are empty inline functions, leaving boothsAlgorithm<NoTrace> with no I/O
+struct NoTrace {
+    void initial(const BoothRegisters&, const PackedRegister&) {}
+    void step(const BoothRegisters&) {}
+};
+
+// Writes every step to a stream (cout, or a buffered file) in the classic trace format
+class StreamTrace {
+private:
+    ostream& out;
+
+public:
+    StreamTrace(ostream& out) : out(out) {}
+
+    void initial(const BoothRegisters& registers, const PackedRegister& M) {
+        out << "Initial Values:\n";
+        out << "A: "; printPacked(registers.A(), out); out << "\n";
+        out << "Q: "; printPacked(registers.Q(), out); out << "\n";
+        out << "M: "; printPacked(M, out); out << "\n";
+        out << "Q-1: " << registers.QMinus1() << "\n";
+        out << "--------------------\n";
+    }
+
+    void step(const BoothRegisters& registers) {
+        out << "A: "; printPacked(registers.A(), out); out << "\n";
+        out << "Q: "; printPacked(registers.Q(), out); out << "\n";
+        out << "Q-1: " << registers.QMinus1() << "\n";
+        out << "--------------------\n";
+    }
+};
+
+// Keeps the most recent steps in memory, across multiplies, until clear(); slots are reused, so
+// recording does not allocate once the buffer has wrapped
+class RingBufferTrace {
+private:
+    struct Slot {
+        BoothRegisters registers = BoothRegisters(0);
+        PackedRegister M;     // Multiplicand, set on a multiply's initial slot
+        bool initial = false;
+    };
+    vector<Slot> steps;
+    size_t next = 0;
+    size_t recorded = 0;
+
+    Slot& record(const BoothRegisters& registers) {
+        Slot& slot = steps[next];
+        slot.registers = registers; // Same size as the slot's previous contents after the first pass
+        next = (next + 1) % steps.size();
+        recorded++;
+        return slot;
+    }
+
+public:
+    RingBufferTrace(size_t capacity) : steps(max<size_t>(1, capacity)) {}
+
+    void initial(const BoothRegisters& registers, const PackedRegister& multiplicand) {
+        Slot& slot = record(registers);
+        slot.M = multiplicand;
+        slot.initial = true;
     }
 
-    // If the number is negative, calculate the Two's Complement
-    if (isNegative) {
-        // Step 1: Invert bits
-        for (int i = 0; i < bitWidth; i++) {
-            binary[i] = !binary[i];
+    void step(const BoothRegisters& registers) { record(registers).initial = false; }
+
+    void clear() { next = recorded = 0; }
+
+    size_t size() const { return min(recorded, steps.size()); }
+    size_t total() const { return recorded; }
+
+    // Replay the retained steps, oldest first, in the classic trace format
+    void print(ostream& out = cout) const {
+        if (recorded > steps.size()) out << "(" << recorded - steps.size() << " earlier steps dropped)\n";
+        size_t first = recorded > steps.size() ? next : 0;
+        for (size_t k = 0; k < size(); k++) {
+            const Slot& slot = steps[(first + k) % steps.size()];
+            if (slot.initial) {
+                out << "Initial Values:\n";
+                out << "M: "; printPacked(slot.M, out); out << "\n";
+            }
+            out << "A: "; printPacked(slot.registers.A(), out); out << "\n";
+            out << "Q: "; printPacked(slot.registers.Q(), out); out << "\n";
+            out << "Q-1: " << slot.registers.QMinus1() << "\n";
+            out << "--------------------\n";
         }
-        // Step 2: Add 1 to the LSB
-        bool carry = 1;
-        for (int i = bitWidth - 1; i >= 0; i--) {
-            binary[i] = binary[i] ^ carry; // XOR with carry
-            carry = binary[i] & carry;    // AND to propagate carry
+    }
+};
+
+//// Booth's Algorithm for Signed Multiplication ////
+template <typename TraceObserver>
+vector<bool> boothsAlgorithm(int multiplicand, int multiplier, int bitWidth, TraceObserver& trace) {
+    // Step 1: Initialize Booth's Algorithm Registers: A = 0, Q = multiplier, Q(-1) = 0, all in one
+    // register pair so a step is one word-wide add and one word-wide shift
+    BoothRegisters registers(bitWidth);
+    PackedRegister Q = packInteger(multiplier, bitWidth); // Multiplier (Q)
+    PackedRegister M = packInteger(multiplicand, bitWidth); // Multiplicand (M)
+    for (int j = 0; j < bitWidth; j++) setBit(registers.AQ.bits, j + 1, Q.bit(j));
+    PackedRegister alignedM = registers.AQ.alignHigh(M); // M lined up with A
+    int count = bitWidth; // Iteration count
+
+    trace.initial(registers, M);
+
+    // Step 2: Booth's Algorithm Iterations
+    while (count > 0) {
+        // Step 2.1: Check Q0 and Q(-1)
+        unsigned window = registers.AQ.bits.words[0] & 3;
+        if (window == 2) {
+            subtractPacked(registers.AQ.bits, alignedM); // Q0 = 1, Q(-1) = 0: A = A - M
+        } else if (window == 1) {
+            addPacked(registers.AQ.bits, alignedM); // Q0 = 0, Q(-1) = 1: A = A + M
         }
+
+        // Step 2.2: Arithmetic Right Shift (ARS) of A:Q:Q(-1), sign-extending A from the guard bit
+        arithmeticShiftRight(registers.AQ.bits, 1);
+
+        // Report current state
+        trace.step(registers);
+
+        count--;
     }
 
-    return binary;
+    // Step 3: A:Q is the final product
+    return unpackBits(registers.AQ.bits, 1, 2 * bitWidth);
 }
 
-// Convert binary (Two's Complement) to integer
-int binaryToInteger(const vector<bool>& binary) {
-    bool isNegative = binary[0]; // Sign bit (MSB)
-    int bitWidth = binary.size();
-    vector<bool> absBinary = binary;
+// Classic form: traces every step to cout
+vector<bool> boothsAlgorithm(int multiplicand, int multiplier, int bitWidth) {
+    StreamTrace trace(cout);
+    return boothsAlgorithm(multiplicand, multiplier, bitWidth, trace);
+}
 
-    // If negative, convert from Two's Complement
-    if (isNegative) {
-        // Step 1: Invert bits
-        for (int i = 0; i < bitWidth; i++) {
-            absBinary[i] = !absBinary[i];
-        }
-        // Step 2: Add 1
-        bool carry = 1;
-        for (int i = bitWidth - 1; i >= 0; i--) {
-            absBinary[i] = absBinary[i] ^ carry;
-            carry = absBinary[i] & carry;
+// Multiply many pairs with tracing compiled out, except every sampleEvery-th pair (0 for none),
+// whose steps go to the given observer
+template <typename TraceObserver>
+vector<vector<bool>> bulkBoothsAlgorithm(const vector<pair<int, int>>& operands, int bitWidth, size_t sampleEvery,
+                                         TraceObserver& trace) {
+    vector<vector<bool>> products;
+    products.reserve(operands.size());
+    NoTrace none;
+    for (size_t k = 0; k < operands.size(); k++) {
+        if (sampleEvery && k % sampleEvery == 0) {
+            products.push_back(boothsAlgorithm(operands[k].first, operands[k].second, bitWidth, trace));
+        } else {
+            products.push_back(boothsAlgorithm(operands[k].first, operands[k].second, bitWidth, none));
         }
     }
+    return products;
+}
+
+//// Modified Booth's Algorithm (Radix-4 / Radix-8) ////
+
+// Bits of the multiplier retired per step
+enum BoothRadix {
+    Radix2 = 1,
+    Radix4 = 2,
+    Radix8 = 3
+};
+
+// Booth's Algorithm on one packed A:Q:Q(-1) register. Each step recodes the low radix + 1 bits
+// (Q's low bits and Q(-1)) into a digit d in [-2^(r-1), 2^(r-1)], adds d * M into A, and shifts
+// the whole register right by r bits, so an n-bit multiply takes ceil(n / r) steps instead of n
+vector<bool> modifiedBoothsAlgorithm(const vector<bool>& multiplicand, const vector<bool>& multiplier, BoothRadix radix) {
+    size_t bitWidth = max(multiplicand.size(), multiplier.size());
+    unsigned r = radix;
+    size_t steps = (bitWidth + r - 1) / r;
+    size_t qWidth = steps * r;          // Q, sign-extended to a whole number of digits
+    size_t aWidth = bitWidth + r + 1;   // A holds up to |M| * 2^r between shifts
+    size_t aOffset = qWidth + 1;        // A sits above Q and Q(-1)
+
+    // A = 0, Q = multiplier, Q(-1) = 0
+    PackedRegister Q = packBinary(multiplier, qWidth);
+    PackedRegister reg(aWidth + qWidth + 1);
+    for (size_t i = 0; i < (qWidth + 63) / 64; i++) reg.words[i] = Q.words[i];
+    if (qWidth % 64) reg.words[qWidth / 64] &= ((uint64_t)1 << (qWidth % 64)) - 1; // Keep A clear of Q's sign
+    shiftLeftPacked(reg, 1);
+
+    // Multiples d * M for every digit, pre-aligned to A's position in the register
+    int maxDigit = 1 << (r - 1);
+    vector<PackedRegister> multiples(2 * maxDigit + 1, PackedRegister(reg.width));
+    PackedRegister M = packBinary(multiplicand, reg.width);
+    shiftLeftPacked(M, aOffset);
+    for (int d = 1; d <= maxDigit; d++) {
+        multiples[maxDigit + d] = multiples[maxDigit + d - 1];
+        addPacked(multiples[maxDigit + d], M);
+        multiples[maxDigit - d] = multiples[maxDigit + d];
+        negatePacked(multiples[maxDigit - d]);
+    }
 
-    // Convert to integer
-    int result = 0;
-    for (int i = 0; i < bitWidth; i++) {
-        result = (result << 1) + absBinary[i];
+    for (size_t step = 0; step < steps; step++) {
+        unsigned window = reg.words[0] & ((1u << (r + 1)) - 1);
+        int digit = (int)(window & 1) + (int)((window >> 1) & ((1u << r) - 1)) - (int)((window >> r) & 1) * (1 << r);
+        if (digit) addPacked(reg, multiples[maxDigit + digit]);
+        arithmeticShiftRight(reg, r);
     }
 
-    return isNegative ? -result : result;
+    // The 2n-bit product sits just above Q(-1), as A:Q does in boothsAlgorithm
+    return unpackBits(reg, 1, 2 * bitWidth);
 }
 
-// Print binary representation
-void printBinary(const vector<bool>& binary) {
-    for (bool bit : binary) {
-        cout << bit;
+vector<bool> modifiedBoothsAlgorithm(int multiplicand, int multiplier, int bitWidth, BoothRadix radix) {
+    return modifiedBoothsAlgorithm(integerToBinary(multiplicand, bitWidth), integerToBinary(multiplier, bitWidth), radix);
+}
+
+//// Partial-Product Tree Multiplier ////
+
+// How the partial-product dot matrix is reduced to two rows
+enum ReductionTree {
+    Wallace,     // Reduce every column as early as possible with 3:2 and 2:2 counters
+    Dadda,       // Reduce each column only down to the next Dadda height (fewest counters)
+    Compressor42 // 4:2 compressors, with 3:2 counters for leftovers and the last stage
+};
+
+struct TreeStats {
+    size_t partialProducts = 0;
+    size_t fullAdders = 0;    // 3:2 counters
+    size_t halfAdders = 0;    // 2:2 counters
+    size_t compressors42 = 0; // 4:2 compressors (each is two chained full adders)
+    size_t depth = 0;         // Reduction stages
+};
+
+// dots[c] holds the bits of weight 2^c
+typedef vector<vector<uint8_t>> DotMatrix;
+
+inline void fullAdderDots(uint8_t a, uint8_t b, uint8_t c, uint8_t& sum, uint8_t& carry) {
+    sum = a ^ b ^ c;
+    carry = (a & b) | (c & (a ^ b));
+}
+
+// Radix-4 Booth partial products: digit i of the multiplier selects 0, +-M or +-2M, which is placed
+// at column 2i and sign-extended to the product width. A negative digit is inverted here and its +1
+// goes in as an extra dot in column 2i, so no row needs a carry-propagate negation
+DotMatrix boothPartialProducts(const vector<bool>& multiplicand, const vector<bool>& multiplier, TreeStats& stats) {
+    size_t bitWidth = max(multiplicand.size(), multiplier.size());
+    size_t productWidth = 2 * bitWidth;
+    PackedRegister M = packBinary(multiplicand, bitWidth + 1);
+    PackedRegister Q = packBinary(multiplier, bitWidth + 2);
+    auto bitOf = [](const PackedRegister& reg, size_t j) { return (reg.words[j / 64] >> (j % 64)) & 1; };
+
+    DotMatrix dots(productWidth);
+    size_t steps = (bitWidth + 1) / 2;
+    for (size_t i = 0; i < steps; i++) {
+        unsigned window = (unsigned)(bitOf(Q, 2 * i + 1) << 2 | bitOf(Q, 2 * i) << 1 | (i ? bitOf(Q, 2 * i - 1) : 0));
+        int digit = (int)(window & 1) + (int)((window >> 1) & 1) - 2 * (int)((window >> 2) & 1);
+        bool negative = digit < 0;
+        size_t magnitude = abs(digit);
+
+        // Row value |d| * M as an (n + 1)-bit Two's Complement number, inverted for negative digits
+        for (size_t j = 0; 2 * i + j < productWidth; j++) {
+            size_t source = min(j, bitWidth); // Sign extension past bit n
+            uint8_t bit = 0;
+            if (magnitude == 1) bit = bitOf(M, source);
+            else if (magnitude == 2) bit = source ? bitOf(M, min(j - 1, bitWidth)) : 0;
+            dots[2 * i + j].push_back(bit ^ (uint8_t)negative);
+        }
+        if (negative) dots[2 * i].push_back(1);
+        stats.partialProducts++;
     }
+    return dots;
 }
 
-//// Booth's Algorithm for Signed Multiplication ////
-vector<bool> boothsAlgorithm(int multiplicand, int multiplier, int bitWidth) {
-    // Step 1: Initialize Booth's Algorithm Registers
-    vector<bool> A(bitWidth, 0); // Accumulator (A)
-    vector<bool> Q = integerToBinary(multiplier, bitWidth); // Multiplier (Q)
-    vector<bool> M = integerToBinary(multiplicand, bitWidth); // Multiplicand (M)
-    bool QMinus1 = 0; // Q(-1) bit
-    int count = bitWidth; // Iteration count
+size_t maxHeight(const DotMatrix& dots) {
+    size_t height = 0;
+    for (const vector<uint8_t>& column : dots) height = max(height, column.size());
+    return height;
+}
 
-    cout << "Initial Values:\n";
-    cout << "A: "; printBinary(A); cout << "\n";
-    cout << "Q: "; printBinary(Q); cout << "\n";
-    cout << "M: "; printBinary(M); cout << "\n";
-    cout << "Q-1: " << QMinus1 << "\n";
-    cout << "--------------------\n";
+// One Wallace stage: every group of three bits in a column goes through a full adder and a leftover
+// pair through a half adder
+DotMatrix wallaceStage(const DotMatrix& dots, TreeStats& stats) {
+    DotMatrix next(dots.size());
+    for (size_t c = 0; c < dots.size(); c++) {
+        const vector<uint8_t>& column = dots[c];
+        size_t k = 0;
+        for (; k + 3 <= column.size(); k += 3) {
+            uint8_t sum, carry;
+            fullAdderDots(column[k], column[k + 1], column[k + 2], sum, carry);
+            next[c].push_back(sum);
+            if (c + 1 < dots.size()) next[c + 1].push_back(carry);
+            stats.fullAdders++;
+        }
+        if (column.size() - k == 2) {
+            next[c].push_back(column[k] ^ column[k + 1]);
+            if (c + 1 < dots.size()) next[c + 1].push_back(column[k] & column[k + 1]);
+            stats.halfAdders++;
+        } else if (column.size() - k == 1) {
+            next[c].push_back(column[k]);
+        }
+    }
+    return next;
+}
 
-    // Step 2: Booth's Algorithm Iterations
-    while (count > 0) {
-        // Step 2.1: Check Q0 and Q(-1)
-        if (Q.back() == 1 && QMinus1 == 0) {
-            // Perform A = A - M (Subtract Multiplicand)
-            bool borrow = 0;
-            for (int i = bitWidth - 1; i >= 0; i--) {
-                bool diff = A[i] ^ (!M[i]) ^ borrow;
-                borrow = (!A[i] & (!M[i])) | (borrow & (!A[i] ^ (!M[i])));
-                A[i] = diff;
+// One Dadda stage: each column, counting the carries arriving from the column below, is reduced just
+// to the target height
+DotMatrix daddaStage(const DotMatrix& dots, size_t target, TreeStats& stats) {
+    DotMatrix next(dots.size());
+    for (size_t c = 0; c < dots.size(); c++) {
+        vector<uint8_t> pending = dots[c];
+        size_t height = pending.size() + next[c].size();
+        while (height > target && pending.size() >= 2) {
+            uint8_t sum, carry;
+            if (height - target >= 2 && pending.size() >= 3) {
+                fullAdderDots(pending[pending.size() - 3], pending[pending.size() - 2], pending.back(), sum, carry);
+                pending.resize(pending.size() - 3);
+                height -= 2;
+                stats.fullAdders++;
+            } else {
+                sum = pending[pending.size() - 2] ^ pending.back();
+                carry = pending[pending.size() - 2] & pending.back();
+                pending.resize(pending.size() - 2);
+                height -= 1;
+                stats.halfAdders++;
             }
-        } else if (Q.back() == 0 && QMinus1 == 1) {
-            // Perform A = A + M (Add Multiplicand)
-            bool carry = 0;
-            for (int i = bitWidth - 1; i >= 0; i--) {
-                bool sum = A[i] ^ M[i] ^ carry;
-                carry = (A[i] & M[i]) | (carry & (A[i] ^ M[i]));
-                A[i] = sum;
+            next[c].push_back(sum);
+            if (c + 1 < dots.size()) next[c + 1].push_back(carry);
+        }
+        next[c].insert(next[c].end(), pending.begin(), pending.end());
+    }
+    return next;
+}
+
+// One 4:2 stage: every group of four bits in a column, plus a lateral carry from the column below,
+// becomes a sum in this column and two carries into the next. The lateral carry out does not depend
+// on the lateral carry in, so the stage has no horizontal ripple
+DotMatrix compressor42Stage(const DotMatrix& dots, TreeStats& stats) {
+    DotMatrix next(dots.size()), lateral(dots.size() + 1);
+    for (size_t c = 0; c < dots.size(); c++) {
+        const vector<uint8_t>& column = dots[c];
+        size_t k = 0, lateralUsed = 0;
+        for (; k + 4 <= column.size(); k += 4) {
+            uint8_t partialSum, lateralCarry, sum, carry;
+            uint8_t carryIn = lateralUsed < lateral[c].size() ? lateral[c][lateralUsed++] : 0;
+            fullAdderDots(column[k], column[k + 1], column[k + 2], partialSum, lateralCarry);
+            fullAdderDots(partialSum, column[k + 3], carryIn, sum, carry);
+            next[c].push_back(sum);
+            lateral[c + 1].push_back(lateralCarry);
+            if (c + 1 < dots.size()) next[c + 1].push_back(carry);
+            stats.compressors42++;
+        }
+        if (column.size() - k == 3) {
+            uint8_t sum, carry;
+            fullAdderDots(column[k], column[k + 1], column[k + 2], sum, carry);
+            next[c].push_back(sum);
+            if (c + 1 < dots.size()) next[c + 1].push_back(carry);
+            stats.fullAdders++;
+            k += 3;
+        }
+        for (; k < column.size(); k++) next[c].push_back(column[k]);
+        for (; lateralUsed < lateral[c].size(); lateralUsed++) next[c].push_back(lateral[c][lateralUsed]);
+    }
+    return next;
+}
+
+// Booth-recoded partial products reduced by a Wallace, Dadda or 4:2 tree to two rows, then one
+// word-wide carry-propagate add. Returns the 2n-bit product in boothsAlgorithm's A:Q format
+vector<bool> treeMultiply(const vector<bool>& multiplicand, const vector<bool>& multiplier, ReductionTree tree,
+                          TreeStats& stats) {
+    stats = TreeStats();
+    size_t productWidth = 2 * max(multiplicand.size(), multiplier.size());
+    DotMatrix dots = boothPartialProducts(multiplicand, multiplier, stats);
+
+    // Dadda heights 2, 3, 4, 6, 9, 13, ... below the starting height, used from the top down
+    vector<size_t> daddaHeights = {2};
+    while (daddaHeights.back() * 3 / 2 < maxHeight(dots)) daddaHeights.push_back(daddaHeights.back() * 3 / 2);
+
+    while (maxHeight(dots) > 2) {
+        if (tree == Wallace) {
+            dots = wallaceStage(dots, stats);
+        } else if (tree == Dadda) {
+            while (daddaHeights.size() > 1 && daddaHeights.back() >= maxHeight(dots)) daddaHeights.pop_back();
+            dots = daddaStage(dots, daddaHeights.back(), stats);
+        } else if (maxHeight(dots) > 3) {
+            dots = compressor42Stage(dots, stats);
+        } else {
+            dots = wallaceStage(dots, stats); // 4:2 compressors cannot finish a height-3 matrix
+        }
+        stats.depth++;
+    }
+
+    // Final carry-propagate add of the two remaining rows, 64 columns per word
+    PackedRegister rowA(productWidth), rowB(productWidth);
+    for (size_t c = 0; c < productWidth; c++) {
+        if (dots[c].size() > 0 && dots[c][0]) rowA.words[c / 64] |= (uint64_t)1 << (c % 64);
+        if (dots[c].size() > 1 && dots[c][1]) rowB.words[c / 64] |= (uint64_t)1 << (c % 64);
+    }
+    signExtend(rowA);
+    signExtend(rowB);
+    addPacked(rowA, rowB);
+    return unpackBits(rowA, 0, productWidth);
+}
+
+vector<bool> treeMultiply(int multiplicand, int multiplier, int bitWidth, ReductionTree tree, TreeStats& stats) {
+    return treeMultiply(integerToBinary(multiplicand, bitWidth), integerToBinary(multiplier, bitWidth), tree, stats);
+}
+
+string treeName(ReductionTree tree) {
+    switch (tree) {
+    case Wallace: return "Wallace";
+    case Dadda: return "Dadda";
+    case Compressor42: return "4:2 Compressor";
+    }
+    return "Unknown";
+}
+
+// Sequential radix-4 Booth against the three reduction trees at 32..1024 bits: wall time per
+// multiply, plus steps (sequential) versus reduction stages and counters (tree)
+void runMultiplierBenchmark(size_t samples = 20, uint64_t seed = 1) {
+    mt19937_64 generator(seed);
+    cout << "Width | Sequential Steps | Sequential us | Tree | Stages | FA | HA | 4:2 | Tree us\n";
+    for (size_t width = 32; width <= 1024; width *= 2) {
+        vector<vector<bool>> A(samples, vector<bool>(width)), B(samples, vector<bool>(width));
+        for (size_t k = 0; k < samples; k++) {
+            for (size_t j = 0; j < width; j++) {
+                A[k][j] = generator() & 1;
+                B[k][j] = generator() & 1;
             }
         }
 
-        // Step 2.2: Arithmetic Right Shift (ARS)
-        QMinus1 = Q.back(); // Update Q(-1) with Q0
-        Q.pop_back();
-        Q.insert(Q.begin(), A.back()); // Shift Q with A's LSB
-        A.insert(A.begin(), A[0]); // Sign-extend A
-        A.pop_back();
+        vector<vector<bool>> expected(samples);
+        auto start = chrono::steady_clock::now();
+        for (size_t k = 0; k < samples; k++) expected[k] = modifiedBoothsAlgorithm(A[k], B[k], Radix4);
+        double sequential = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / samples;
 
-        // Print current state
-        cout << "A: "; printBinary(A); cout << "\n";
-        cout << "Q: "; printBinary(Q); cout << "\n";
-        cout << "Q-1: " << QMinus1 << "\n";
-        cout << "--------------------\n";
+        for (ReductionTree tree : {Wallace, Dadda, Compressor42}) {
+            TreeStats stats;
+            bool matches = true;
+            start = chrono::steady_clock::now();
+            for (size_t k = 0; k < samples; k++) matches &= treeMultiply(A[k], B[k], tree, stats) == expected[k];
+            double treeTime = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / samples;
 
-        count--;
+            cout << width << " | " << (width + 1) / 2 << " | " << sequential << " | " << treeName(tree) << " | "
+                 << stats.depth << " | " << stats.fullAdders << " | " << stats.halfAdders << " | " << stats.compressors42
+                 << " | " << treeTime << (matches ? "" : " (MISMATCH)") << "\n";
+        }
     }
+}
 
-    // Step 3: Combine A and Q as the final product
-    vector<bool> product;
-    product.insert(product.end(), A.begin(), A.end());
-    product.insert(product.end(), Q.begin(), Q.end());
-    return product;
+//// Differential Verification ////
+
+// bulkBoothsAlgorithm with every sampleEvery-th multiply traced into a RingBufferTrace: products
+// must match native multiplication, and the ring must hold the last steps of the sampled multiplies
+uint64_t verifyBulkTrace(uint64_t samples, uint64_t seed = 1) {
+    const int width = 16;
+    const size_t sampleEvery = 64, capacity = 4 * (width + 1);
+    mt19937_64 generator(seed);
+    vector<pair<int, int>> operands(samples);
+    for (pair<int, int>& operand : operands) operand = {(int16_t)generator(), (int16_t)generator()};
+
+    RingBufferTrace trace(capacity);
+    vector<vector<bool>> products = bulkBoothsAlgorithm(operands, width, sampleEvery, trace);
+    uint64_t mismatches = 0;
+    for (size_t k = 0; k < samples; k++) {
+        mismatches += binaryToInt128(products[k]) != (__int128)operands[k].first * operands[k].second;
+    }
+
+    size_t tracedSteps = (samples + sampleEvery - 1) / sampleEvery * (width + 1);
+    bool retained = trace.total() == tracedSteps && trace.size() == min(capacity, tracedSteps);
+    cout << "bulkBoothsAlgorithm (ring trace) @ " << width << " bits: " << samples << " products, " << mismatches
+         << " mismatches, " << trace.size() << " of " << trace.total() << " traced steps retained"
+         << (retained ? "" : " (EXPECTED " + to_string(tracedSteps) + ")") << "\n";
+    return mismatches + !retained;
+}
+
+// Check every multiplier engine against native multiplication: exhaustive at 8 (and optionally 16)
+// bits, random samples above that. The vector<bool> engines go up to 62 bits; the classic
+// int-based boothsAlgorithm stops at 31
+void runVerification(size_t threads, uint64_t samples, int exhaustiveWidth) {
+    vector<pair<string, function<__int128(int64_t, int64_t, int)>>> engines = {
+        {"boothsAlgorithm", [](int64_t a, int64_t b, int width) {
+             NoTrace none;
+             return binaryToInt128(boothsAlgorithm((int)a, (int)b, width, none));
+         }},
+        {"Radix-2 Booth", [](int64_t a, int64_t b, int width) {
+             return binaryToInt128(modifiedBoothsAlgorithm(operandToBinary(a, width), operandToBinary(b, width), Radix2));
+         }},
+        {"Radix-4 Booth", [](int64_t a, int64_t b, int width) {
+             return binaryToInt128(modifiedBoothsAlgorithm(operandToBinary(a, width), operandToBinary(b, width), Radix4));
+         }},
+        {"Radix-8 Booth", [](int64_t a, int64_t b, int width) {
+             return binaryToInt128(modifiedBoothsAlgorithm(operandToBinary(a, width), operandToBinary(b, width), Radix8));
+         }}};
+    for (ReductionTree tree : {Wallace, Dadda, Compressor42}) {
+        engines.push_back({treeName(tree) + " tree", [tree](int64_t a, int64_t b, int width) {
+                               TreeStats stats;
+                               return binaryToInt128(treeMultiply(operandToBinary(a, width), operandToBinary(b, width), tree, stats));
+                           }});
+    }
+
+    uint64_t mismatches = 0;
+    for (const auto& engine : engines) {
+        for (int width : {8, 16, 24, 31, 62}) {
+            if (width > 31 && engine.first == "boothsAlgorithm") continue;
+            VerificationReport report = width <= exhaustiveWidth
+                ? verifyExhaustive(engine.first, width, engine.second, threads)
+                : verifyRandom(engine.first, width, samples, engine.second, threads);
+            printVerificationReport(report);
+            mismatches += report.mismatches;
+        }
+    }
+    mismatches += verifyBulkTrace(samples);
+    cout << (mismatches ? "FAIL" : "PASS") << "\n";
 }
 
 //// Main Function ////
-int main() {
-    int multiplicand, multiplier;
+int main(int argc, char* argv[]) {
+    // Benchmark mode: BoothsAlgorithm --bench
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        runMultiplierBenchmark();
+        return 0;
+    }
+
+    // Verification mode: BoothsAlgorithm --verify [threads] [samples] [exhaustive width]
+    if (argc > 1 && string(argv[1]) == "--verify") {
+        uint64_t threads = max(1u, thread::hardware_concurrency()), samples = 100000, exhaustiveWidth = 8;
+        if ((argc > 2 && !parseVerificationArgument(argv[2], 1, 4096, threads)) ||
+            (argc > 3 && !parseVerificationArgument(argv[3], 1, (uint64_t)1 << 40, samples)) ||
+            (argc > 4 && !parseVerificationArgument(argv[4], 0, maxExhaustiveWidth, exhaustiveWidth))) {
+            cerr << "Usage: BoothsAlgorithm --verify [threads 1-4096] [samples 1-2^40] [exhaustive width 0-"
+                 << maxExhaustiveWidth << "]\n";
+            return 1;
+        }
+        runVerification(threads, samples, (int)exhaustiveWidth);
+        return 0;
+    }
+
+    int multiplicand, multiplier, radix;
 
     // Take inputs from the user
     cout << "Enter the multiplicand (signed integer): ";
@@ -141,11 +562,19 @@ int main() {
     cout << "Enter the multiplier (signed integer): ";
     cin >> multiplier;
 
+    cout << "Enter the radix (2 for step-by-step trace, 4 or 8 for modified Booth): ";
+    cin >> radix;
+
     // Determine the bit width (based on the magnitude of inputs)
-    int bitWidth = max(8, max(to_string(abs(multiplicand)).length() * 4, to_string(abs(multiplier)).length() * 4));
+    int bitWidth = max<int>(8, max(to_string(abs(multiplicand)).length() * 4, to_string(abs(multiplier)).length() * 4));
 
     // Perform Booth's Algorithm for signed multiplication
-    vector<bool> product = boothsAlgorithm(multiplicand, multiplier, bitWidth);
+    vector<bool> product;
+    if (radix == 4 || radix == 8) {
+        product = modifiedBoothsAlgorithm(multiplicand, multiplier, bitWidth, radix == 4 ? Radix4 : Radix8);
+    } else {
+        product = boothsAlgorithm(multiplicand, multiplier, bitWidth);
+    }
 
     // Display Results
     cout << "\nMultiplicand: " << multiplicand << " (Binary: ";
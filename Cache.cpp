@@ -1,9 +1,23 @@
 #include <iostream>
+#include <fstream>
 #include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <functional>
 #include <unordered_map>
-#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdexcept>
+#include <chrono>
 #include <ctime>
 #include <cstdlib>
+#include <cerrno>
+#include "MappedFile.h"
 
 using namespace std;
 
@@ -12,174 +26,2351 @@ int getRandomIndex(int size) {
     return rand() % size;
 }
 
-// Cache Block Structure
+// Index of the lowest set bit (mask != 0)
+inline int lowestSetBit(uint64_t mask) {
+    return __builtin_ctzll(mask);
+}
+
+// Bits first..last set
+inline uint64_t bitRange(int first, int last) {
+    return (last == 63 ? ~(uint64_t)0 : ((uint64_t)1 << (last + 1)) - 1) & ~(((uint64_t)1 << first) - 1);
+}
+
+// Cache Block Structure (one way of a set). The tag is kept in CacheLevel::tags and the line's
+// words in CacheLevel's data arena
 struct CacheBlock {
-    int tag;
-    int data;
+    uint64_t dirtyMask; // For Write-back policy: one bit per dirty word (or sub-block of words)
+    uint64_t usedMask;  // Words read or written since the line entered the hierarchy, in dirty-mask bits
+                        // (false-sharing detection; carried between levels with the line)
     bool valid;
-    bool dirty; // For Write-back policy
-    CacheBlock() : tag(-1), data(0), valid(false), dirty(false) {}
+    uint8_t lruPrev, lruNext; // Links of the set's recency list (LRU, FIFO)
+    uint8_t frequency;        // Saturating use count (LFU)
+    uint8_t state;            // CoherenceState of the line (multicore)
+    bool prefetched;          // Brought in by a prefetch and not yet used by a demand access
+    CacheBlock()
+        : dirtyMask(0), usedMask(0), valid(false), lruPrev(0), lruNext(0), frequency(0), state(0), prefetched(false) {}
+};
+
+struct AlignedFree {
+    void operator()(int* pointer) const { free(pointer); }
+};
+
+// Replacement state of one set
+struct CacheSet {
+    uint64_t validMask = 0;          // Bit w set when way w holds a block
+    uint64_t mruBits = 0;            // Bit-PLRU: ways used since the bits last reset
+    uint8_t lruHead = 0, lruTail = 0; // Most and least recently used (or inserted, for FIFO) way
+    uint16_t agingCounter = 0;       // LFU: accesses since the counts were last halved
+};
+
+// Replacement Policies
+enum ReplacementPolicy {
+    LRU,
+    FIFO,
+    LFU,
+    Random,
+    PseudoLRU // Bit-PLRU (one MRU bit per way)
+};
+
+// Write Policies
+enum WritePolicy {
+    WriteThrough,
+    BufferedWriteThrough,
+    WriteBack
+};
+
+// Mapping Functions
+enum MappingFunction {
+    Direct,
+    Associative,
+    SetAssociative
+};
+
+// Cache Coherency Mechanisms
+enum CoherencyMechanism {
+    BusWatching,
+    HardwareTransparency,
+    CacheFlushing
+};
+
+// Line states of a private cache in a multicore system; a block no level holds is Invalid
+enum CoherenceState : uint8_t {
+    InvalidState,
+    SharedState,    // Clean, other cores may hold it
+    ExclusiveState, // Clean, no other core holds it (MESI, MOESI)
+    OwnedState,     // Dirty, other cores may hold it Shared; this core answers for it (MOESI)
+    ModifiedState   // Dirty, no other core holds it
+};
+
+// Inclusion Policies between stacked cache levels
+enum InclusionPolicy {
+    Inclusive,   // Every block of a level is also in the levels below it
+    Exclusive,   // A block lives in exactly one level; lower levels hold the victims of upper ones
+    NonInclusive // Blocks are filled into every level but evicted independently
+};
+
+string levelName(size_t level) {
+    return "L" + to_string(level + 1);
+}
+
+//// Cache Level ////
+
+// Access counters of one cache level
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+    uint64_t writebackBytes = 0; // Dirty bytes written to the level below or to memory
+};
+
+// One N-way set-associative level. The ways of set s are stored contiguously at
+// blocks[s * ways, (s + 1) * ways), and the tag is the block number above the set index. Tags
+// live in their own array, so the tag compare of a set reads one or two host cache lines.
+// The words of every line sit in one 64-byte-aligned arena, line i at arena[i * lineStride]
+class CacheLevel {
+private:
+    vector<CacheBlock> blocks;
+    vector<int64_t> tags; // -1 until the way is first filled
+    vector<CacheSet> sets;
+    unique_ptr<int, AlignedFree> arena; // Null for a tag-only level
+    size_t lineStride = 0;
+    int ways;
+    int setCount;
+    int setShift;      // log2(setCount) when it is a power of two, else -1
+    uint64_t fullMask; // One bit per way
+    ReplacementPolicy replacementPolicy;
+
+    static const int lfuAgingPeriod = 64; // Set accesses between halvings of the LFU counts
+
+    // Recency list: head is the most recently used way, tail the next victim
+    void unlink(CacheSet& set, CacheBlock* way, int w) {
+        if (set.lruHead == w) set.lruHead = way[w].lruNext;
+        else way[way[w].lruPrev].lruNext = way[w].lruNext;
+        if (set.lruTail == w) set.lruTail = way[w].lruPrev;
+        else way[way[w].lruNext].lruPrev = way[w].lruPrev;
+    }
+
+    void moveToHead(CacheSet& set, CacheBlock* way, int w) {
+        if (set.lruHead == w) return;
+        unlink(set, way, w);
+        way[w].lruNext = set.lruHead;
+        way[set.lruHead].lruPrev = w;
+        set.lruHead = w;
+    }
+
+    void moveToTail(CacheSet& set, CacheBlock* way, int w) {
+        if (set.lruTail == w) return;
+        unlink(set, way, w);
+        way[w].lruPrev = set.lruTail;
+        way[set.lruTail].lruNext = w;
+        set.lruTail = w;
+    }
+
+public:
+    CacheStats stats;
+
+    // lineWords is the block size in words, or 0 to keep no line data
+    CacheLevel(int cacheSize, int associativity, MappingFunction mappingFunction, ReplacementPolicy replacementPolicy,
+               int lineWords)
+        : replacementPolicy(replacementPolicy) {
+        ways = mappingFunction == Direct ? 1 : mappingFunction == Associative ? cacheSize : associativity;
+        if (ways < 1 || ways > 64 || cacheSize % ways != 0) {
+            throw invalid_argument("cache of " + to_string(cacheSize) + " blocks cannot have " + to_string(ways) +
+                                   " ways (1 to 64, dividing the block count)");
+        }
+        setCount = cacheSize / ways;
+        setShift = (setCount & (setCount - 1)) ? -1 : __builtin_ctz(setCount);
+        fullMask = ways == 64 ? ~(uint64_t)0 : ((uint64_t)1 << ways) - 1;
+        blocks.resize(cacheSize);
+        tags.resize(cacheSize, -1);
+        sets.resize(setCount);
+
+        // Lines that divide a 64-byte host line are packed; longer ones are padded to whole host
+        // lines, so no line straddles more host lines than it must
+        if (lineWords > 0) {
+            const size_t hostLineWords = 64 / sizeof(int);
+            lineStride = hostLineWords % lineWords == 0 ? lineWords
+                                                         : (lineWords + hostLineWords - 1) / hostLineWords * hostLineWords;
+            size_t bytes = (cacheSize * lineStride * sizeof(int) + 63) / 64 * 64;
+            arena.reset(static_cast<int*>(aligned_alloc(64, bytes)));
+            if (!arena) throw bad_alloc();
+            memset(arena.get(), 0, bytes);
+        }
+
+        // Each recency list starts as ways 0, 1, ..., ways - 1
+        for (int s = 0; s < setCount; s++) {
+            CacheBlock* way = &blocks[s * ways];
+            for (int w = 0; w < ways; w++) {
+                way[w].lruPrev = w - 1;
+                way[w].lruNext = w + 1;
+            }
+            sets[s].lruHead = 0;
+            sets[s].lruTail = ways - 1;
+        }
+    }
+
+    int wayCount() const { return ways; }
+    int setTotal() const { return setCount; }
+
+    // Power-of-two set counts index with a mask and shift instead of a division
+    int setIndexOf(int64_t blockNumber) const {
+        return setShift >= 0 ? blockNumber & (setCount - 1) : blockNumber % setCount;
+    }
+    int64_t tagOf(int64_t blockNumber) const { return setShift >= 0 ? blockNumber >> setShift : blockNumber / setCount; }
+
+    CacheBlock& block(int set, int way) { return blocks[set * ways + way]; }
+    const CacheBlock& block(int set, int way) const { return blocks[set * ways + way]; }
+
+    // Words of the line in (set, way), or null for a tag-only level
+    int* line(int set, int way) { return arena ? arena.get() + (size_t)(set * ways + way) * lineStride : nullptr; }
+
+    int64_t tagAt(int set, int way) const { return tags[set * ways + way]; }
+    int64_t blockNumberOf(int set, int way) const { return tags[set * ways + way] * setCount + set; }
+
+    // Way of the set holding blockNumber, or -1. The tag is compared across all ways without an
+    // early exit, since which way hits is data-dependent and would mispredict
+    int find(int set, int64_t blockNumber) const {
+        int64_t tag = tagOf(blockNumber);
+        const int64_t* way = &tags[set * ways];
+        uint64_t match = 0;
+        for (int w = 0; w < ways; w++) match |= (uint64_t)(way[w] == tag) << w;
+        match &= sets[set].validMask;
+        return match ? lowestSetBit(match) : -1;
+    }
+
+    // Update the replacement state for a use of the way (hits and fills)
+    void touch(int set, int w) {
+        CacheSet& state = sets[set];
+        CacheBlock* way = &blocks[set * ways];
+        switch (replacementPolicy) {
+        case LRU:
+            moveToHead(state, way, w);
+            break;
+        case PseudoLRU:
+            state.mruBits |= (uint64_t)1 << w;
+            // Once every way is marked, restart from this one; a 1-way set keeps none, so
+            // chooseVictim always finds a clear bit
+            if (state.mruBits == fullMask) state.mruBits = ways == 1 ? 0 : (uint64_t)1 << w;
+            break;
+        case LFU:
+            if (way[w].frequency < 255) way[w].frequency++;
+            if (++state.agingCounter == lfuAgingPeriod) {
+                state.agingCounter = 0;
+                for (int i = 0; i < ways; i++) way[i].frequency >>= 1;
+            }
+            break;
+        case FIFO:
+        case Random:
+            break;
+        }
+    }
+
+    // Way to fill next: an invalid way if any, otherwise the policy's victim
+    int chooseVictim(int set) {
+        CacheSet& state = sets[set];
+        if (state.validMask != fullMask) return lowestSetBit(~state.validMask & fullMask);
+
+        switch (replacementPolicy) {
+        case LRU:
+        case FIFO:
+            return state.lruTail;
+        case PseudoLRU:
+            return lowestSetBit(~state.mruBits & fullMask);
+        case LFU: {
+            const CacheBlock* way = &blocks[set * ways];
+            int victim = 0;
+            for (int w = 1; w < ways; w++) {
+                if (way[w].frequency < way[victim].frequency) victim = w;
+            }
+            return victim;
+        }
+        case Random:
+            return getRandomIndex(ways);
+        }
+        return 0;
+    }
+
+    // Place blockNumber into an invalid way, copying its words from payload (lineWords of them)
+    void install(int set, int w, int64_t blockNumber, const int* payload, int lineWords, uint64_t dirtyMask,
+                 uint8_t state) {
+        CacheBlock& target = blocks[set * ways + w];
+        tags[set * ways + w] = tagOf(blockNumber);
+        if (arena && payload) memcpy(line(set, w), payload, lineWords * sizeof(int));
+        target.valid = true;
+        target.dirtyMask = dirtyMask;
+        target.usedMask = 0;
+        target.frequency = 0;
+        target.state = state;
+        target.prefetched = false;
+        sets[set].validMask |= (uint64_t)1 << w;
+        if (replacementPolicy == FIFO) moveToHead(sets[set], &blocks[set * ways], w);
+        touch(set, w);
+    }
+
+    // The line's words stay in the arena until the way is filled again
+    void invalidate(int set, int w) {
+        CacheSet& state = sets[set];
+        blocks[set * ways + w].valid = false;
+        blocks[set * ways + w].dirtyMask = 0;
+        state.validMask &= ~((uint64_t)1 << w);
+        state.mruBits &= ~((uint64_t)1 << w);
+        if (replacementPolicy == LRU || replacementPolicy == FIFO) moveToTail(state, &blocks[set * ways], w);
+    }
+};
+
+// Geometry and replacement policy of one level of the hierarchy
+struct CacheLevelConfig {
+    int cacheSize; // In blocks
+    int associativity;
+    MappingFunction mappingFunction;
+    ReplacementPolicy replacementPolicy;
+};
+
+//// Write Buffer ////
+
+// Memory port timing and write buffer of the buffered write-through model, in processor cycles.
+// The processor issues one access per cycle; the memory port serves one fetch or write at a time
+struct WriteBufferConfig {
+    int entries = 8;                  // Lines the buffer holds
+    int highWatermark = 6;            // Occupancy that starts a drain burst
+    int lowWatermark = 2;             // ...which continues down to this occupancy
+    int idleCycles = 4;               // Port idle time after which the oldest entry drains (0: never)
+    bool drainOnReadConflict = false; // A miss to a buffered line drains up to it instead of forwarding
+    int memoryReadCycles = 20;        // Port time of a block fetch
+    int memoryWriteCycles = 10;       // Port time of a drained entry, a write-through or a write-back
+};
+
+struct WriteBufferStats {
+    uint64_t writes = 0;
+    uint64_t coalesced = 0;      // Writes merged into an entry already in the buffer
+    uint64_t drains = 0;         // Entries written to memory
+    uint64_t forwardedReads = 0; // Misses whose line was completed from the buffer
+    uint64_t conflictDrains = 0; // Entries drained early for a miss to a buffered line
+    uint64_t fullStalls = 0;     // Writes that found the buffer full
+};
+
+// Bounded FIFO of pending line writes. A write to a line already in the buffer merges into its
+// entry, which keeps the line's written sub-blocks (words) and a mask of them like a dirty mask
+class WriteBuffer {
+private:
+    vector<int64_t> blockNumbers;
+    vector<uint64_t> masks;
+    vector<uint64_t> insertedAt; // Cycle the entry was created
+    vector<int> words;           // lineWords per entry; empty for a tag-only cache
+    int capacity;
+    int lineWords;
+    int head = 0, count = 0;
+
+    int slot(int position) const { return (head + position) % capacity; }
+
+public:
+    WriteBuffer(int capacity = 8, int lineWords = 0)
+        : blockNumbers(capacity), masks(capacity), insertedAt(capacity), words((size_t)capacity * lineWords),
+          capacity(capacity), lineWords(lineWords) {}
+
+    int size() const { return count; }
+    bool full() const { return count == capacity; }
+
+    // Position (0 = oldest) of the entry for blockNumber, or -1
+    int find(int64_t blockNumber) const {
+        for (int position = 0; position < count; position++) {
+            if (blockNumbers[slot(position)] == blockNumber) return position;
+        }
+        return -1;
+    }
+
+    int64_t blockAt(int position) const { return blockNumbers[slot(position)]; }
+    uint64_t maskAt(int position) const { return masks[slot(position)]; }
+    uint64_t insertedAtCycle(int position) const { return insertedAt[slot(position)]; }
+    int* wordsAt(int position) { return lineWords ? &words[(size_t)slot(position) * lineWords] : nullptr; }
+
+    // New empty entry at the tail (not full); returns its position
+    int push(int64_t blockNumber, uint64_t cycle) {
+        int tail = slot(count);
+        blockNumbers[tail] = blockNumber;
+        masks[tail] = 0;
+        insertedAt[tail] = cycle;
+        return count++;
+    }
+
+    void addMask(int position, uint64_t mask) { masks[slot(position)] |= mask; }
+
+    void pop() {
+        head = (head + 1) % capacity;
+        count--;
+    }
+};
+
+//// Prefetchers ////
+
+enum PrefetchKind { PrefetchNone, PrefetchNextLine, PrefetchStride, PrefetchStream, PrefetchDelta };
+
+// What a level saw for a demand access
+enum PrefetchEvent {
+    DemandMiss,
+    PrefetchHit, // First demand use of a line a prefetch brought in
+    DemandHit
+};
+
+struct PrefetcherConfig {
+    PrefetchKind kind = PrefetchNone;
+    int degree = 2;             // Blocks proposed per trigger (the starting value when throttled)
+    int maxDegree = 8;
+    int queueEntries = 16;      // Proposals waiting to be issued; new ones are dropped when it is full
+    int tableEntries = 64;      // Stride: PC table entries. Stream: streams. Delta: PC index entries
+    int historyEntries = 256;   // Delta: global history buffer entries
+    int distance = 16;          // Stream: blocks the prefetches may run ahead of the demand stream
+    bool throttle = true;       // Raise or lower the degree from each interval's accuracy
+    int throttleInterval = 128; // Prefetches issued per throttling decision
+};
+
+struct PrefetchStats {
+    uint64_t requested = 0;     // Blocks proposed
+    uint64_t queueDrops = 0;    // ...dropped because the queue was full or already held them
+    uint64_t redundant = 0;     // ...already in the level when their turn came
+    uint64_t issued = 0;        // Prefetch fills
+    uint64_t useful = 0;        // Prefetched lines that a demand access used
+    uint64_t late = 0;          // ...before their fetch had finished, so the access waited
+    uint64_t lateCycles = 0;    // Cycles those accesses waited
+    uint64_t unused = 0;        // Prefetched lines evicted before any demand use
+    uint64_t pollution = 0;     // Demand misses to lines that a prefetch fill had evicted
+    uint64_t throttleUps = 0, throttleDowns = 0;
+};
+
+// Trains on the demand accesses of one level and proposes blocks to bring into it
+class Prefetcher {
+public:
+    virtual ~Prefetcher() {}
+
+    // Append up to `degree` blocks to prefetch after a demand access to blockNumber by the
+    // instruction at pc (0 when the caller has no PC)
+    virtual void train(int64_t blockNumber, uint64_t pc, PrefetchEvent event, int degree, vector<int64_t>& requests) = 0;
+};
+
+// Tagged next-line: a miss or the first use of a prefetched line asks for the blocks after it
+class NextLinePrefetcher : public Prefetcher {
+public:
+    void train(int64_t blockNumber, uint64_t, PrefetchEvent event, int degree, vector<int64_t>& requests) override {
+        if (event == DemandHit) return;
+        for (int k = 1; k <= degree; k++) requests.push_back(blockNumber + k);
+    }
+};
+
+// Reference prediction table: per PC, the last block and stride, trusted after two repeats
+class StridePrefetcher : public Prefetcher {
+private:
+    struct Entry {
+        uint64_t pc = 0;
+        int64_t lastBlock = -1;
+        int64_t stride = 0;
+        int confidence = 0; // 0 to 3; prefetches from 2
+    };
+    vector<Entry> table;
+
+public:
+    explicit StridePrefetcher(int entries) : table(max(1, entries)) {}
+
+    void train(int64_t blockNumber, uint64_t pc, PrefetchEvent, int degree, vector<int64_t>& requests) override {
+        Entry& entry = table[(pc >> 2) % table.size()];
+        if (entry.pc != pc || entry.lastBlock < 0) {
+            entry = Entry();
+            entry.pc = pc;
+            entry.lastBlock = blockNumber;
+            return;
+        }
+        int64_t stride = blockNumber - entry.lastBlock;
+        if (stride == 0) return;
+        if (stride == entry.stride) {
+            entry.confidence = min(entry.confidence + 1, 3);
+        } else if (--entry.confidence <= 0) {
+            entry.confidence = 0;
+            entry.stride = stride;
+        }
+        entry.lastBlock = blockNumber;
+        if (entry.confidence < 2) return;
+        for (int k = 1; k <= degree; k++) requests.push_back(blockNumber + k * entry.stride);
+    }
+};
+
+// Stream buffers: each tracks one ascending or descending run of misses. Two misses close together
+// set its direction; later misses further along advance it, and its prefetches run up to
+// `distance` blocks ahead of the latest one. A miss no stream expects takes the least recently
+// used stream
+class StreamPrefetcher : public Prefetcher {
+private:
+    struct Stream {
+        int64_t lastBlock = 0;
+        int64_t nextPrefetch = 0;
+        int direction = 0; // 0 while training
+        uint64_t lastUse = 0;
+        bool valid = false;
+    };
+    static const int window = 16; // Blocks a miss may skip and still belong to the stream
+
+    vector<Stream> streams;
+    int distance;
+    uint64_t uses = 0;
+
+public:
+    StreamPrefetcher(int count, int distance) : streams(max(1, count)), distance(max(1, distance)) {}
+
+    void train(int64_t blockNumber, uint64_t, PrefetchEvent event, int degree, vector<int64_t>& requests) override {
+        if (event == DemandHit) return;
+        Stream* match = nullptr;
+        Stream* victim = &streams[0];
+        for (Stream& stream : streams) {
+            int64_t step = blockNumber - stream.lastBlock;
+            bool follows = stream.direction ? step * stream.direction > 0 && step * stream.direction <= window
+                                            : step != 0 && step >= -window && step <= window;
+            if (stream.valid && follows) {
+                match = &stream;
+                break;
+            }
+            if (!stream.valid || stream.lastUse < victim->lastUse) victim = &stream;
+        }
+        uses++;
+        if (!match) {
+            *victim = Stream();
+            victim->lastBlock = victim->nextPrefetch = blockNumber;
+            victim->lastUse = uses;
+            victim->valid = true;
+            return;
+        }
+
+        if (!match->direction) {
+            match->direction = blockNumber > match->lastBlock ? 1 : -1;
+            match->nextPrefetch = blockNumber;
+        }
+        match->lastBlock = blockNumber;
+        match->lastUse = uses;
+        int direction = match->direction;
+        if ((match->nextPrefetch - blockNumber) * direction <= 0) match->nextPrefetch = blockNumber + direction;
+        for (int k = 0; k < degree && (match->nextPrefetch - blockNumber) * direction <= distance; k++) {
+            requests.push_back(match->nextPrefetch);
+            match->nextPrefetch += direction;
+        }
+    }
+};
+
+// PC/DC delta correlation over a global history buffer (GHB): the misses of each PC are linked
+// through the buffer, newest first. The last two deltas of a PC are looked up further back in its
+// history, and the deltas that followed that earlier occurrence are replayed from the current block
+class DeltaCorrelationPrefetcher : public Prefetcher {
+private:
+    struct HistoryEntry {
+        int64_t blockNumber;
+        uint64_t previous; // Sequence number of the PC's previous entry, or noEntry
+    };
+    struct IndexEntry {
+        uint64_t pc = 0;
+        uint64_t latest = noEntry;
+    };
+    static const uint64_t noEntry = ~(uint64_t)0;
+    static const int maxHistory = 16; // Entries of a PC's chain that are searched
+
+    vector<HistoryEntry> history;
+    vector<IndexEntry> index;
+    uint64_t sequence = 0; // Entries ever inserted; entry s lives at history[s % size] until overwritten
+
+    bool live(uint64_t entry) const { return entry != noEntry && sequence - entry <= history.size(); }
+
+public:
+    DeltaCorrelationPrefetcher(int indexEntries, int historyEntries)
+        : history(max(1, historyEntries)), index(max(1, indexEntries)) {}
+
+    void train(int64_t blockNumber, uint64_t pc, PrefetchEvent event, int degree, vector<int64_t>& requests) override {
+        if (event == DemandHit) return;
+        IndexEntry& head = index[(pc >> 2) % index.size()];
+        if (head.pc != pc) {
+            head.pc = pc;
+            head.latest = noEntry;
+        }
+        history[sequence % history.size()] = {blockNumber, live(head.latest) ? head.latest : noEntry};
+        head.latest = sequence++;
+
+        // Deltas of the PC's chain, newest first
+        int64_t deltas[maxHistory];
+        int count = 0;
+        int64_t newer = blockNumber;
+        for (uint64_t entry = history[head.latest % history.size()].previous; live(entry) && count < maxHistory;
+             entry = history[entry % history.size()].previous) {
+            int64_t older = history[entry % history.size()].blockNumber;
+            deltas[count++] = newer - older;
+            newer = older;
+        }
+        if (count < 3) return;
+
+        for (int match = 1; match + 1 < count; match++) {
+            if (deltas[match] != deltas[0] || deltas[match + 1] != deltas[1]) continue;
+            // deltas[match - 1] .. deltas[0] followed the match; repeat them while the degree lasts
+            int64_t next = blockNumber;
+            for (int k = 0; k < degree; k++) {
+                next += deltas[match - 1 - k % match];
+                requests.push_back(next);
+            }
+            return;
+        }
+    }
+};
+
+inline unique_ptr<Prefetcher> makePrefetcher(const PrefetcherConfig& config) {
+    switch (config.kind) {
+    case PrefetchNextLine:
+        return unique_ptr<Prefetcher>(new NextLinePrefetcher());
+    case PrefetchStride:
+        return unique_ptr<Prefetcher>(new StridePrefetcher(config.tableEntries));
+    case PrefetchStream:
+        return unique_ptr<Prefetcher>(new StreamPrefetcher(config.tableEntries, config.distance));
+    case PrefetchDelta:
+        return unique_ptr<Prefetcher>(new DeltaCorrelationPrefetcher(config.tableEntries, config.historyEntries));
+    case PrefetchNone:
+        break;
+    }
+    return nullptr;
+}
+
+const char* prefetchKindName(PrefetchKind kind) {
+    static const char* names[] = {"None", "Next-Line", "Stride", "Stream", "Delta Correlation"};
+    return names[kind];
+}
+
+// The prefetch machinery of one level: its prefetcher, the queue of proposals waiting to issue,
+// the prefetches still in flight, a filter of lines that prefetch fills evicted (to catch the
+// misses they cause), and the throttle
+class PrefetchUnit {
+private:
+    unique_ptr<Prefetcher> prefetcher;
+    vector<int64_t> queue; // Ring of proposals
+    int queueHead = 0, queueCount = 0;
+    vector<pair<int64_t, uint64_t>> inFlight; // Block and the cycle its fetch finishes
+    vector<int64_t> evictedByPrefetch;        // Direct-mapped on the block number
+    vector<int64_t> requests;
+    uint64_t intervalIssued = 0, intervalUseful = 0;
+
+    static const int pollutionFilterSize = 1024;
+
+public:
+    PrefetcherConfig config;
+    PrefetchStats stats;
+    int degree;
+
+    explicit PrefetchUnit(const PrefetcherConfig& config)
+        : prefetcher(makePrefetcher(config)), queue(max(1, config.queueEntries)),
+          evictedByPrefetch(pollutionFilterSize, -1), config(config), degree(max(1, config.degree)) {}
+
+    // Train on a demand access; `wanted` filters the proposals (blocks that may be cached)
+    template <typename Wanted>
+    void observe(int64_t blockNumber, uint64_t pc, PrefetchEvent event, Wanted wanted) {
+        requests.clear();
+        prefetcher->train(blockNumber, pc, event, degree, requests);
+        for (int64_t request : requests) {
+            if (!wanted(request)) continue;
+            stats.requested++;
+            bool queued = false;
+            for (int i = 0; i < queueCount && !queued; i++) queued = queue[(queueHead + i) % queue.size()] == request;
+            if (queued || queueCount == (int)queue.size()) {
+                stats.queueDrops++;
+                continue;
+            }
+            queue[(queueHead + queueCount++) % queue.size()] = request;
+        }
+    }
+
+    bool pending() const { return queueCount > 0; }
+    int64_t front() const { return queue[queueHead]; }
+    void pop() {
+        queueHead = (queueHead + 1) % queue.size();
+        queueCount--;
+    }
+
+    // A prefetch fill whose fetch finishes at readyAt; every throttleInterval of them, a degree
+    // step up when at least 3/4 were used, down when fewer than 2/5 were
+    void issued(int64_t blockNumber, uint64_t now, uint64_t readyAt) {
+        stats.issued++;
+        inFlight.erase(remove_if(inFlight.begin(), inFlight.end(), [&](const pair<int64_t, uint64_t>& entry) {
+                           return entry.second <= now;
+                       }), inFlight.end());
+        if (readyAt > now) inFlight.push_back({blockNumber, readyAt});
+
+        if (!config.throttle || ++intervalIssued < (uint64_t)config.throttleInterval) return;
+        if (intervalUseful * 4 >= intervalIssued * 3 && degree < config.maxDegree) {
+            degree++;
+            stats.throttleUps++;
+        } else if (intervalUseful * 5 < intervalIssued * 2 && degree > 1) {
+            degree--;
+            stats.throttleDowns++;
+        }
+        intervalIssued = intervalUseful = 0;
+    }
+
+    // First demand use of a prefetched line. Returns the cycle its fetch finishes (0 if it has)
+    uint64_t used(int64_t blockNumber, uint64_t now) {
+        stats.useful++;
+        intervalUseful++;
+        for (const pair<int64_t, uint64_t>& entry : inFlight) {
+            if (entry.first == blockNumber && entry.second > now) {
+                stats.late++;
+                stats.lateCycles += entry.second - now;
+                return entry.second;
+            }
+        }
+        return 0;
+    }
+
+    void evictedForPrefetch(int64_t blockNumber) { evictedByPrefetch[blockNumber % pollutionFilterSize] = blockNumber; }
+
+    // A demand miss: was the block pushed out by a prefetch?
+    void demandMissed(int64_t blockNumber) {
+        int64_t& slot = evictedByPrefetch[blockNumber % pollutionFilterSize];
+        if (slot != blockNumber) return;
+        stats.pollution++;
+        slot = -1;
+    }
+};
+
+//// Cache Memory ////
+
+// Per-access output of accessMemory and the helpers below it. LogOff compiles every message out,
+// for trace replay
+enum CacheLogging { LogOff, LogAccesses };
+
+// Cache hierarchy (L1 first) in front of a simulated DRAM. All levels share the block size, and
+// addresses and block sizes count words of the DRAM. A main memory size of 0 gives a tag-only
+// cache: no line data, byte addresses and any 64-bit address
+class CacheMemory {
+private:
+    vector<CacheLevel> levels;
+    vector<int> mainMemory; // Simulated DRAM
+    vector<bool> nonCacheableMemory; // Tracks non-cacheable memory regions
+    vector<int> lineBuffer; // A line in flight between levels
+
+    // Buffered Write-Through: the write buffer and the memory port it drains through
+    WriteBuffer writeBuffer;
+    WriteBufferConfig timing;
+    uint64_t portFreeAt = 0;       // Cycle the memory port finishes its current transfer
+    bool drainBurst = false;       // Draining from the high down to the low watermark
+    uint64_t drainBurstSince = 0;
+
+    // Prefetch units by level (null: none), and whether a fill in progress is a prefetch's
+    vector<unique_ptr<PrefetchUnit>> prefetchUnits;
+    bool prefetching = false;
+    bool prefetchFilling = false;
+
+    int blockSize;
+    int blockShift; // log2(blockSize) when it is a power of two, else -1
+    int mainMemorySize;
+    int wordBytes;     // sizeof(int), or 1 for a tag-only cache
+    int subBlockWords; // Words per dirty-mask bit: 1 up to 64-word blocks
+    InclusionPolicy inclusionPolicy;
+    WritePolicy writePolicy;
+    CoherencyMechanism coherencyMechanism;
+
+    // Block of the previous access and its L1 way. Anything that changes L1 outside accessMemory
+    // must reset lastBlockNumber
+    int64_t lastBlockNumber = -1;
+    int lastSet = 0, lastWay = 0;
+
+    int readMemory(uint64_t address) const { return address < mainMemory.size() ? mainMemory[address] : 0; }
+    void writeMemory(uint64_t address, int data) {
+        if (address < mainMemory.size()) mainMemory[address] = data;
+    }
+
+    // Dirty-mask bits of words [offset, offset + count) of a line
+    uint64_t dirtyBits(int offset, int count) const {
+        return bitRange(offset / subBlockWords, (offset + count - 1) / subBlockWords);
+    }
+
+    // Words covered by the set bits of a dirty mask, and their size in bytes
+    int dirtyWords(uint64_t dirtyMask) const {
+        int count = __builtin_popcountll(dirtyMask) * subBlockWords;
+        int lastBit = (blockSize - 1) / subBlockWords; // The last sub-block can be short
+        if ((dirtyMask >> lastBit) & 1) count -= (lastBit + 1) * subBlockWords - blockSize;
+        return count;
+    }
+    uint64_t dirtyBytes(uint64_t dirtyMask) const { return (uint64_t)dirtyWords(dirtyMask) * wordBytes; }
+
+    // Store the dirty sub-blocks of a line (null for a tag-only cache) in main memory
+    void storeDirtyWords(int64_t blockNumber, const int* words, uint64_t dirtyMask) {
+        if (!words) return;
+        uint64_t mainMemoryAddress = blockNumber * blockSize;
+        for (; dirtyMask; dirtyMask &= dirtyMask - 1) {
+            int first = lowestSetBit(dirtyMask) * subBlockWords;
+            for (int w = first; w < min(first + subBlockWords, blockSize); w++) writeMemory(mainMemoryAddress + w, words[w]);
+        }
+    }
+
+    // Copy the dirty sub-blocks of a line onto another copy of it
+    void copyDirtyWords(int* to, const int* from, uint64_t dirtyMask) const {
+        if (!to || !from) return;
+        for (; dirtyMask; dirtyMask &= dirtyMask - 1) {
+            int first = lowestSetBit(dirtyMask) * subBlockWords;
+            memcpy(to + first, from + first, min(subBlockWords, blockSize - first) * sizeof(int));
+        }
+    }
+
+    // Occupy the memory port for `cycles`, from `now` or once it frees up. Returns the finish cycle
+    uint64_t usePort(uint64_t now, int cycles) {
+        portFreeAt = max(now, portFreeAt) + cycles;
+        return portFreeAt;
+    }
+
+    // Write the oldest buffer entry to memory, starting at cycle `start`
+    template <CacheLogging Logging>
+    void drainOldestEntry(uint64_t start) {
+        uint64_t mainMemoryAddress = writeBuffer.blockAt(0) * blockSize;
+        uint64_t mask = writeBuffer.maskAt(0);
+        storeDirtyWords(writeBuffer.blockAt(0), writeBuffer.wordsAt(0), mask);
+        usePort(start, timing.memoryWriteCycles);
+        memoryWriteBytes += dirtyBytes(mask);
+        writeBufferStats.drains++;
+        if constexpr (Logging == LogAccesses) {
+            cout << "Write Buffer Drain: Address = " << mainMemoryAddress << ", Words = " << dirtyWords(mask) << endl;
+        }
+        writeBuffer.pop();
+        if (writeBuffer.size() <= timing.lowWatermark) drainBurst = false;
+    }
+
+    // Drain in the background every entry whose drain would have started before cycle `now`: during
+    // a watermark burst as soon as the port is free, otherwise once the port has idled idleCycles
+    template <CacheLogging Logging>
+    void drainWriteBuffer(uint64_t now) {
+        while (writeBuffer.size() > 0) {
+            uint64_t start;
+            if (drainBurst) start = max(portFreeAt, drainBurstSince);
+            else if (timing.idleCycles > 0) start = max(portFreeAt, writeBuffer.insertedAtCycle(0)) + timing.idleCycles;
+            else break;
+            if (start >= now) break;
+            drainOldestEntry<Logging>(start);
+        }
+    }
+
+    // Drain the oldest entries until `entries` have gone, with the processor waiting. Returns the stall
+    template <CacheLogging Logging>
+    uint64_t drainAndWait(int entries) {
+        uint64_t stall = 0;
+        for (int i = 0; i < entries; i++) {
+            drainOldestEntry<Logging>(max(cycle, portFreeAt));
+            stall += portFreeAt - cycle;
+            cycle = portFreeAt;
+        }
+        return stall;
+    }
+
+    // Record a write of words [offset, offset + size) of a block in the write buffer, copying the
+    // written sub-blocks from the block's L1 line
+    template <CacheLogging Logging>
+    void bufferWrite(int64_t blockNumber, int offset, int size, const int* line) {
+        writeBufferStats.writes++;
+        int position = writeBuffer.find(blockNumber);
+        if (position >= 0) {
+            writeBufferStats.coalesced++;
+        } else {
+            if (writeBuffer.full()) {
+                writeBufferStats.fullStalls++;
+                writeStallCycles += drainAndWait<Logging>(1);
+            }
+            position = writeBuffer.push(blockNumber, cycle);
+            if (writeBuffer.size() >= timing.highWatermark && !drainBurst) {
+                drainBurst = true;
+                drainBurstSince = cycle;
+            }
+        }
+        uint64_t mask = dirtyBits(offset, size);
+        copyDirtyWords(writeBuffer.wordsAt(position), line, mask);
+        writeBuffer.addMask(position, mask);
+    }
+
+    // Write a dirty block evicted from level `from` into the next level that holds it, else to
+    // memory. Only the dirty sub-blocks move
+    template <CacheLogging Logging>
+    void writeBackBlock(size_t from, int64_t blockNumber, const int* words, uint64_t dirtyMask) {
+        uint64_t bytes = dirtyBytes(dirtyMask);
+        levels[from].stats.writebacks++;
+        levels[from].stats.writebackBytes += bytes;
+        for (size_t i = from + 1; i < levels.size(); i++) {
+            int set = levels[i].setIndexOf(blockNumber);
+            int way = levels[i].find(set, blockNumber);
+            if (way >= 0) {
+                copyDirtyWords(levels[i].line(set, way), words, dirtyMask);
+                levels[i].block(set, way).dirtyMask |= dirtyMask;
+                if constexpr (Logging == LogAccesses) {
+                    cout << "Write-Back: Block = " << blockNumber << " into " << levelName(i)
+                         << ", Dirty Words = " << dirtyWords(dirtyMask) << endl;
+                }
+                return;
+            }
+        }
+
+        uint64_t mainMemoryAddress = blockNumber * blockSize;
+        storeDirtyWords(blockNumber, words, dirtyMask);
+        memoryWritebacks++;
+        memoryWriteBytes += bytes;
+        usePort(cycle, timing.memoryWriteCycles); // Leaves through the port without stalling the processor
+        if constexpr (Logging == LogAccesses) {
+            cout << "Write-Back: Address = " << mainMemoryAddress << ", Dirty Words = " << dirtyWords(dirtyMask) << endl;
+        }
+    }
+
+    // Remove the block in (set, way) of a level, keeping the hierarchy consistent. Its words stay
+    // in the level's arena until that way is filled again, which happens only after this returns
+    template <CacheLogging Logging>
+    void evictBlock(size_t level, int set, int way) {
+        uint64_t dirtyMask = levels[level].block(set, way).dirtyMask;
+        uint64_t usedMask = levels[level].block(set, way).usedMask;
+        uint8_t state = levels[level].block(set, way).state;
+        int* words = levels[level].line(set, way);
+        int64_t victimNumber = levels[level].blockNumberOf(set, way);
+        levels[level].stats.evictions++;
+        if (PrefetchUnit* unit = prefetching ? prefetchUnits[level].get() : nullptr) {
+            if (levels[level].block(set, way).prefetched) unit->stats.unused++;
+            if (prefetchFilling) unit->evictedForPrefetch(victimNumber);
+        }
+        levels[level].invalidate(set, way);
+
+        // Inclusive: the upper copies go too. Their dirty words are newer, the highest copy's newest,
+        // so walk upwards merging them into the victim
+        if (inclusionPolicy == Inclusive) {
+            for (size_t i = level; i-- > 0;) {
+                int upperSet = levels[i].setIndexOf(victimNumber);
+                int upperWay = levels[i].find(upperSet, victimNumber);
+                if (upperWay < 0) continue;
+                uint64_t upperDirty = levels[i].block(upperSet, upperWay).dirtyMask;
+                copyDirtyWords(words, levels[i].line(upperSet, upperWay), upperDirty);
+                dirtyMask |= upperDirty;
+                usedMask |= levels[i].block(upperSet, upperWay).usedMask;
+                levels[i].invalidate(upperSet, upperWay);
+                if constexpr (Logging == LogAccesses) {
+                    cout << "Back-Invalidate: Block = " << victimNumber << " in " << levelName(i) << endl;
+                }
+            }
+        }
+
+        // Exclusive: the victim moves down a level, clean or dirty
+        if (inclusionPolicy == Exclusive && level + 1 < levels.size()) {
+            int lowerWay = fillLevel<Logging>(level + 1, victimNumber, words, dirtyMask, state);
+            if (onDeparture) levels[level + 1].block(levels[level + 1].setIndexOf(victimNumber), lowerWay).usedMask = usedMask;
+            return;
+        }
+        if (dirtyMask) writeBackBlock<Logging>(level, victimNumber, words, dirtyMask);
+        if (onDeparture) {
+            // The words this copy saw stay with the line while any level still holds it
+            if (usedMask) mergeUsedMask(level + 1, victimNumber, usedMask);
+            if (findCopy(victimNumber, set, way) == levels.size()) onDeparture(victimNumber, state);
+        }
+    }
+
+    // Multicore: OR usedMask into the highest copy of a block at or below `from`, if any
+    void mergeUsedMask(size_t from, int64_t blockNumber, uint64_t usedMask) {
+        for (size_t i = from; i < levels.size(); i++) {
+            int set = levels[i].setIndexOf(blockNumber);
+            int way = levels[i].find(set, blockNumber);
+            if (way >= 0) {
+                levels[i].block(set, way).usedMask |= usedMask;
+                return;
+            }
+        }
+    }
+
+    // Place a block into a level, evicting its set's victim if the set is full. Returns the way
+    template <CacheLogging Logging>
+    int fillLevel(size_t level, int64_t blockNumber, const int* words, uint64_t dirtyMask, uint8_t state) {
+        int set = levels[level].setIndexOf(blockNumber);
+        int way = levels[level].chooseVictim(set);
+        if (levels[level].block(set, way).valid) evictBlock<Logging>(level, set, way);
+        levels[level].install(set, way, blockNumber, words, blockSize, dirtyMask, state);
+        return way;
+    }
+
+    // Read a block from memory into lineBuffer through the memory port. A demand fetch waits for the
+    // port and the transfer; a prefetch only occupies the port
+    template <CacheLogging Logging>
+    void fetchBlockFromMemory(int64_t blockNumber, bool demand) {
+        uint64_t blockStartAddress = blockNumber * blockSize;
+
+        // Read-after-write conflict: memory is stale where the write buffer holds the line
+        int buffered = writePolicy == BufferedWriteThrough ? writeBuffer.find(blockNumber) : -1;
+        if (buffered >= 0 && demand && timing.drainOnReadConflict) {
+            writeBufferStats.conflictDrains += buffered + 1;
+            readStallCycles += drainAndWait<Logging>(buffered + 1);
+            buffered = -1;
+        }
+
+        if (mainMemorySize > 0) {
+            for (int w = 0; w < blockSize; w++) lineBuffer[w] = readMemory(blockStartAddress + w);
+        }
+        if (demand) {
+            readStallCycles += max(cycle, portFreeAt) - cycle;
+            cycle = usePort(cycle, timing.memoryReadCycles);
+        } else {
+            usePort(cycle, timing.memoryReadCycles);
+        }
+        if (demand && suppliedByCache) {
+            suppliedByCache = false;
+            cacheToCacheFills++;
+        } else {
+            memoryFetches++;
+            memoryReadBytes += (uint64_t)blockSize * wordBytes;
+        }
+
+        if (buffered >= 0) {
+            copyDirtyWords(lineBuffer.data(), writeBuffer.wordsAt(buffered), writeBuffer.maskAt(buffered));
+            writeBufferStats.forwardedReads++;
+            if constexpr (Logging == LogAccesses) cout << "Forwarded From Write Buffer: Block = " << blockNumber << endl;
+        }
+        if constexpr (Logging == LogAccesses) {
+            cout << (demand ? "Fetched Block: Address = " : "Prefetched Block: Address = ") << blockStartAddress
+                 << ", Data = " << (mainMemorySize > 0 ? lineBuffer[0] : 0) << endl;
+        }
+    }
+
+    // Whether a prefetcher may ask for a block: inside memory and cacheable
+    bool prefetchable(int64_t blockNumber) const {
+        if (blockNumber < 0) return false;
+        if (mainMemorySize == 0) return true;
+        uint64_t blockStartAddress = blockNumber * blockSize;
+        return blockStartAddress + blockSize <= (uint64_t)mainMemorySize && !nonCacheableMemory[blockStartAddress];
+    }
+
+    // Tell the prefetch units of the levels a demand access reached what each saw: a miss at those
+    // above hitLevel, a hit at hitLevel (set and way). A late prefetch stalls the access
+    void trainPrefetchers(int64_t blockNumber, uint64_t pc, size_t hitLevel, int set, int way) {
+        for (size_t i = 0; i <= hitLevel && i < levels.size(); i++) {
+            PrefetchUnit* unit = prefetchUnits[i].get();
+            if (!unit) continue;
+            PrefetchEvent event = DemandMiss;
+            if (i < hitLevel) {
+                unit->demandMissed(blockNumber);
+            } else if (levels[i].block(set, way).prefetched) {
+                levels[i].block(set, way).prefetched = false;
+                event = PrefetchHit;
+                if (uint64_t readyAt = unit->used(blockNumber, cycle)) {
+                    readStallCycles += readyAt - cycle; // The access waits for the fill like a fetch would
+                    cycle = readyAt;
+                }
+            } else {
+                event = DemandHit;
+            }
+            unit->observe(blockNumber, pc, event, [&](int64_t request) { return prefetchable(request); });
+        }
+    }
+
+    // Bring a block into `level` for its prefetcher, from `source` (the level holding it, or
+    // levels.size() for memory), filling as a demand miss would but no higher than `level`
+    template <CacheLogging Logging>
+    void prefetchBlock(size_t level, int64_t blockNumber, size_t source) {
+        const int* words = mainMemorySize > 0 ? lineBuffer.data() : nullptr;
+        uint64_t dirtyMask = 0, usedMask = 0, readyAt = cycle;
+        uint8_t state = 0;
+        if (source < levels.size()) {
+            int set = levels[source].setIndexOf(blockNumber), way = levels[source].find(set, blockNumber);
+            if (words) memcpy(lineBuffer.data(), levels[source].line(set, way), blockSize * sizeof(int));
+            state = levels[source].block(set, way).state;
+            usedMask = levels[source].block(set, way).usedMask;
+            if (inclusionPolicy == Exclusive) {
+                dirtyMask = levels[source].block(set, way).dirtyMask;
+                levels[source].invalidate(set, way);
+            }
+        } else {
+            fetchBlockFromMemory<Logging>(blockNumber, false);
+            readyAt = portFreeAt;
+        }
+
+        prefetchFilling = true;
+        size_t fillFrom = inclusionPolicy == Exclusive ? level : source - 1;
+        int way = 0;
+        for (size_t i = fillFrom + 1; i-- > level;) {
+            way = fillLevel<Logging>(i, blockNumber, words, i == level ? dirtyMask : 0, state);
+        }
+        prefetchFilling = false;
+        CacheBlock& filled = levels[level].block(levels[level].setIndexOf(blockNumber), way);
+        filled.prefetched = true;
+        if (onDeparture) filled.usedMask = usedMask;
+        prefetchUnits[level]->issued(blockNumber, cycle, readyAt);
+        lastBlockNumber = -1; // The fills may have moved L1 lines
+        if constexpr (Logging == LogAccesses) {
+            cout << "Prefetch: Block = " << blockNumber << " into " << levelName(level) << endl;
+        }
+    }
+
+    // Issue queued prefetches, oldest first. A block the level or one above it already holds is
+    // dropped (an exclusive hierarchy must not get a second copy). One that must come from memory
+    // waits for an idle memory port, so demand fetches keep priority
+    template <CacheLogging Logging>
+    void issuePrefetches() {
+        for (size_t level = 0; level < levels.size(); level++) {
+            PrefetchUnit* unit = prefetchUnits[level].get();
+            while (unit && unit->pending()) {
+                int64_t blockNumber = unit->front();
+                int set, way;
+                if (findCopy(blockNumber, set, way) <= level) {
+                    unit->stats.redundant++;
+                    unit->pop();
+                    continue;
+                }
+                size_t source = level + 1;
+                while (source < levels.size() && levels[source].find(levels[source].setIndexOf(blockNumber), blockNumber) < 0) {
+                    source++;
+                }
+                if (source == levels.size() && portFreeAt > cycle) break;
+                unit->pop();
+                prefetchBlock<Logging>(level, blockNumber, source);
+            }
+        }
+    }
+
+    // Level holding the highest copy of a block, with its set and way; levels.size() when none does
+    size_t findCopy(int64_t blockNumber, int& set, int& way) const {
+        for (size_t i = 0; i < levels.size(); i++) {
+            set = levels[i].setIndexOf(blockNumber);
+            way = levels[i].find(set, blockNumber);
+            if (way >= 0) return i;
+        }
+        return levels.size();
+    }
+
+public:
+    uint64_t memoryFetches = 0;    // Blocks read from main memory
+    uint64_t memoryWritebacks = 0; // Dirty blocks written back to main memory
+    uint64_t memoryReadBytes = 0;  // Memory traffic: block fetches and non-cacheable reads
+    uint64_t memoryWriteBytes = 0; // Memory traffic: dirty sub-blocks, write-through, drained and non-cacheable writes
+    uint64_t cacheToCacheFills = 0; // Multicore: misses another core's cache served instead of memory
+
+    uint64_t cycle = 0;            // Processor time, one cycle per access plus stalls
+    uint64_t readStallCycles = 0;  // Waiting for the memory port (and conflict drains) before a fetch
+    uint64_t writeStallCycles = 0; // Waiting for write-through writes or for a full write buffer
+    WriteBufferStats writeBufferStats;
+
+    // Multicore: called with a block and its coherence state when the block leaves every level.
+    // While it is set, lines also track the words used since their fill
+    function<void(int64_t, uint8_t)> onDeparture;
+
+    // Multicore: another core's cache supplies the next demand fetch, so it is no memory traffic
+    bool suppliedByCache = false;
+
+    CacheMemory(const vector<CacheLevelConfig>& levelConfigs, int blockSize, int mainMemorySize,
+                InclusionPolicy inclusionPolicy, WritePolicy writePolicy, CoherencyMechanism coherencyMechanism)
+        : blockSize(blockSize), mainMemorySize(mainMemorySize), inclusionPolicy(inclusionPolicy),
+          writePolicy(writePolicy), coherencyMechanism(coherencyMechanism) {
+        blockShift = (blockSize & (blockSize - 1)) ? -1 : __builtin_ctz(blockSize);
+        wordBytes = mainMemorySize > 0 ? sizeof(int) : 1;
+        subBlockWords = (blockSize + 63) / 64;
+        for (const CacheLevelConfig& config : levelConfigs) {
+            levels.emplace_back(config.cacheSize, config.associativity, config.mappingFunction, config.replacementPolicy,
+                                mainMemorySize > 0 ? blockSize : 0);
+        }
+        lineBuffer.resize(blockSize);
+        prefetchUnits.resize(levels.size());
+        writeBuffer = WriteBuffer(timing.entries, mainMemorySize > 0 ? blockSize : 0);
+        mainMemory.resize(mainMemorySize, 0); // Initialize main memory
+        nonCacheableMemory.resize(mainMemorySize, false); // Default: all memory cacheable
+    }
+
+    // Single-level cache
+    CacheMemory(int cacheSize, int blockSize, int mainMemorySize, int associativity,
+                ReplacementPolicy replacementPolicy, WritePolicy writePolicy,
+                MappingFunction mappingFunction, CoherencyMechanism coherencyMechanism)
+        : CacheMemory({{cacheSize, associativity, mappingFunction, replacementPolicy}}, blockSize, mainMemorySize,
+                      Inclusive, writePolicy, coherencyMechanism) {}
+
+    int getBlockSize() const { return blockSize; }
+    size_t levelCount() const { return levels.size(); }
+
+    // Attach a prefetcher to a level (L1 is 0), replacing any it had; PrefetchNone removes it
+    void configurePrefetcher(size_t level, const PrefetcherConfig& config) {
+        if (level >= levels.size()) throw invalid_argument("no level " + levelName(level) + " to prefetch into");
+        prefetchUnits[level].reset(config.kind == PrefetchNone ? nullptr : new PrefetchUnit(config));
+        prefetching = false;
+        for (const unique_ptr<PrefetchUnit>& unit : prefetchUnits) prefetching |= unit != nullptr;
+    }
+
+    // Prefetch counters of a level, or null when it has no prefetcher
+    const PrefetchUnit* prefetchUnit(size_t level) const { return prefetchUnits[level].get(); }
+    const CacheStats& levelStats(size_t level) const { return levels[level].stats; }
+
+    // Dirty-mask bits of the `size` words at address (all within one block)
+    uint64_t accessBits(uint64_t address, int size) const {
+        return dirtyBits(address - address / blockSize * blockSize, size);
+    }
+
+    // Coherence operations of the multicore system below, each on every level's copy of a block
+
+    // State of a block's copies (every level holding it agrees), or InvalidState
+    uint8_t coherenceState(int64_t blockNumber) const {
+        if (blockNumber == lastBlockNumber) return levels[0].block(lastSet, lastWay).state;
+        int set, way;
+        size_t level = findCopy(blockNumber, set, way);
+        return level < levels.size() ? levels[level].block(set, way).state : (uint8_t)InvalidState;
+    }
+
+    void setCoherenceState(int64_t blockNumber, uint8_t state) {
+        for (CacheLevel& level : levels) {
+            int set = level.setIndexOf(blockNumber), way = level.find(set, blockNumber);
+            if (way >= 0) level.block(set, way).state = state;
+        }
+    }
+
+    // Add dirty sub-blocks to the highest copy (a line taken over from another core's dirty copy)
+    void markDirty(int64_t blockNumber, uint64_t dirtyMask) {
+        int set, way;
+        size_t level = findCopy(blockNumber, set, way);
+        if (level < levels.size()) levels[level].block(set, way).dirtyMask |= dirtyMask;
+    }
+
+    // Write a block's dirty words to memory and keep its copies, now clean. Returns the dirty bytes
+    uint64_t flushBlock(int64_t blockNumber) {
+        uint64_t dirtyMask = 0;
+        for (size_t i = levels.size(); i-- > 0;) { // Lowest first, so the newest words land last
+            int set = levels[i].setIndexOf(blockNumber), way = levels[i].find(set, blockNumber);
+            if (way < 0 || !levels[i].block(set, way).dirtyMask) continue;
+            storeDirtyWords(blockNumber, levels[i].line(set, way), levels[i].block(set, way).dirtyMask);
+            dirtyMask |= levels[i].block(set, way).dirtyMask;
+            levels[i].block(set, way).dirtyMask = 0;
+        }
+        if (!dirtyMask) return 0;
+        memoryWritebacks++;
+        memoryWriteBytes += dirtyBytes(dirtyMask);
+        return dirtyBytes(dirtyMask);
+    }
+
+    // Drop every copy of a block without writing it back (another core takes the line over).
+    // Returns false if no level held it; otherwise dirtyMask and usedMask gather the copies' masks
+    bool invalidateBlock(int64_t blockNumber, uint64_t& dirtyMask, uint64_t& usedMask) {
+        bool found = false;
+        dirtyMask = usedMask = 0;
+        for (CacheLevel& level : levels) {
+            int set = level.setIndexOf(blockNumber), way = level.find(set, blockNumber);
+            if (way < 0) continue;
+            found = true;
+            dirtyMask |= level.block(set, way).dirtyMask;
+            usedMask |= level.block(set, way).usedMask;
+            level.invalidate(set, way);
+        }
+        if (blockNumber == lastBlockNumber) lastBlockNumber = -1;
+        return found;
+    }
+
+    // Replace the write buffer and memory timing (drains anything still buffered first)
+    void configureWriteBuffer(const WriteBufferConfig& config) {
+        drainAndWait<LogOff>(writeBuffer.size());
+        timing = config;
+        timing.entries = max(1, timing.entries);
+        writeBuffer = WriteBuffer(timing.entries, mainMemorySize > 0 ? blockSize : 0);
+        drainBurst = false;
+    }
+
+    void markNonCacheableMemory(int start, int end) {
+        for (int i = start; i <= end; i++) {
+            nonCacheableMemory[i] = true;
+        }
+    }
+
+    // Read or write the `size` words at address (all within one block; a write stores writeData in
+    // each) for the instruction at pc, which only PC-indexed prefetchers use. Returns the word at
+    // address after the access
+    template <CacheLogging Logging = LogAccesses>
+    int accessMemory(uint64_t address, int writeData = -1, bool isWrite = false, int size = 1, uint64_t pc = 0) {
+        cycle++;
+        if (writePolicy == BufferedWriteThrough) drainWriteBuffer<Logging>(cycle);
+
+        // Handle Non-Cacheable Memory (the processor waits for the port transfer)
+        if (address < nonCacheableMemory.size() && nonCacheableMemory[address]) {
+            if constexpr (Logging == LogAccesses) cout << "Accessing Non-Cacheable Memory: Address = " << address;
+            if (isWrite) {
+                for (int w = 0; w < size; w++) writeMemory(address + w, writeData);
+                memoryWriteBytes += (uint64_t)size * wordBytes;
+                cycle = usePort(cycle, timing.memoryWriteCycles);
+                if constexpr (Logging == LogAccesses) cout << ", Write Data = " << writeData << endl;
+            } else {
+                memoryReadBytes += (uint64_t)size * wordBytes;
+                cycle = usePort(cycle, timing.memoryReadCycles);
+                if constexpr (Logging == LogAccesses) cout << ", Read Data = " << readMemory(address) << endl;
+            }
+            return readMemory(address);
+        }
+
+        int64_t blockNumber = blockShift >= 0 ? address >> blockShift : address / blockSize;
+        int offset = address - blockNumber * blockSize;
+
+        // Look the block up level by level. A repeat of the previous access's block is an L1 hit at
+        // the remembered way, which skips the lookup for runs of accesses within one block
+        size_t hitLevel = levels.size();
+        int set = lastSet, way = lastWay;
+        if (blockNumber == lastBlockNumber) {
+            hitLevel = 0;
+            levels[0].stats.hits++;
+        }
+        for (size_t i = 0; i < levels.size() && hitLevel; i++) {
+            set = levels[i].setIndexOf(blockNumber);
+            way = levels[i].find(set, blockNumber);
+            if (way >= 0) {
+                hitLevel = i;
+                levels[i].stats.hits++;
+                break;
+            }
+            levels[i].stats.misses++;
+        }
+        if (prefetching && blockNumber != lastBlockNumber) trainPrefetchers(blockNumber, pc, hitLevel, set, way);
+
+        if (hitLevel == 0) {
+            // Cache Hit
+            levels[0].touch(set, way);
+            if constexpr (Logging == LogAccesses) {
+                const int* words = levels[0].line(set, way);
+                cout << "Cache Hit: Address = " << address << ", Data = " << (words ? words[offset] : 0) << endl;
+            }
+        } else {
+            // The line is staged in lineBuffer, since filling L1 can reuse the way it came from
+            const int* words = mainMemorySize > 0 ? lineBuffer.data() : nullptr;
+            uint64_t dirtyMask = 0, usedMask = 0;
+            uint8_t state = 0; // A fetched block's coherence state is up to the multicore system
+            if (hitLevel < levels.size()) {
+                // Hit in a lower level: promote the block to L1
+                const int* found = levels[hitLevel].line(set, way);
+                state = levels[hitLevel].block(set, way).state;
+                usedMask = levels[hitLevel].block(set, way).usedMask;
+                if (words) memcpy(lineBuffer.data(), found, blockSize * sizeof(int));
+                if constexpr (Logging == LogAccesses) {
+                    cout << "Cache Miss: Address = " << address << ", " << levelName(hitLevel)
+                         << " Hit, Data = " << (words ? words[offset] : 0) << endl;
+                }
+                if (inclusionPolicy == Exclusive) {
+                    dirtyMask = levels[hitLevel].block(set, way).dirtyMask;
+                    levels[hitLevel].invalidate(set, way);
+                } else {
+                    levels[hitLevel].touch(set, way);
+                }
+            } else {
+                // Cache Miss: fetch the whole block from memory
+                if constexpr (Logging == LogAccesses) cout << "Cache Miss: Address = " << address << endl;
+                fetchBlockFromMemory<Logging>(blockNumber, true);
+            }
+
+            // Exclusive fills only L1; the others fill every level above the one that had it
+            size_t fillFrom = inclusionPolicy == Exclusive ? 0 : hitLevel - 1;
+            for (size_t i = fillFrom + 1; i-- > 0;) {
+                way = fillLevel<Logging>(i, blockNumber, words, i == 0 ? dirtyMask : 0, state);
+            }
+            set = levels[0].setIndexOf(blockNumber);
+            if (onDeparture) levels[0].block(set, way).usedMask = usedMask;
+        }
+        lastBlockNumber = blockNumber;
+        lastSet = set;
+        lastWay = way;
+
+        int* words = levels[0].line(set, way);
+        if (onDeparture) levels[0].block(set, way).usedMask |= dirtyBits(offset, size); // Multicore only
+        if (isWrite) {
+            if (words) {
+                for (int w = offset; w < offset + size; w++) words[w] = writeData;
+            }
+            if (writePolicy == WriteBack) {
+                levels[0].block(set, way).dirtyMask |= dirtyBits(offset, size);
+            } else {
+                // Write-through keeps every cached copy and the next stage current
+                for (size_t i = 1; i < levels.size() && words; i++) {
+                    int lowerSet = levels[i].setIndexOf(blockNumber);
+                    int lowerWay = levels[i].find(lowerSet, blockNumber);
+                    if (lowerWay < 0) continue;
+                    int* lowerWords = levels[i].line(lowerSet, lowerWay);
+                    for (int w = offset; w < offset + size; w++) lowerWords[w] = writeData;
+                }
+                if (writePolicy == WriteThrough) {
+                    for (int w = 0; w < size; w++) writeMemory(address + w, writeData);
+                    memoryWriteBytes += (uint64_t)size * wordBytes;
+                    uint64_t done = usePort(cycle, timing.memoryWriteCycles);
+                    writeStallCycles += done - cycle;
+                    cycle = done;
+                }
+                if (writePolicy == BufferedWriteThrough) bufferWrite<Logging>(blockNumber, offset, size, words);
+            }
+        }
+        int data = words ? words[offset] : 0;
+        if (prefetching) issuePrefetches<Logging>();
+        return data;
+    }
+
+    template <CacheLogging Logging = LogAccesses>
+    void flushCache() {
+        if constexpr (Logging == LogAccesses) cout << "\nFlushing Cache..." << endl;
+        drainAndWait<Logging>(writeBuffer.size());
+        // Top level first, so dirty L1 data lands in L2 before L2 is flushed
+        for (size_t i = 0; i < levels.size(); i++) {
+            CacheLevel& level = levels[i];
+            for (int set = 0; set < level.setTotal(); set++) {
+                for (int way = 0; way < level.wayCount(); way++) {
+                    CacheBlock& block = level.block(set, way);
+                    if (block.valid && block.dirtyMask && writePolicy == WriteBack) {
+                        if constexpr (Logging == LogAccesses) {
+                            cout << "Flushed Dirty Block: " << levelName(i) << ", Block = " << level.blockNumberOf(set, way) << endl;
+                        }
+                        writeBackBlock<Logging>(i, level.blockNumberOf(set, way), level.line(set, way), block.dirtyMask);
+                        block.dirtyMask = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    void printCacheStatus() {
+        cout << "\n--- Cache Status ---" << endl;
+        for (size_t i = 0; i < levels.size(); i++) {
+            CacheLevel& level = levels[i];
+            cout << levelName(i) << ": " << level.setTotal() << " Sets x " << level.wayCount() << " Ways" << endl;
+            for (int set = 0; set < level.setTotal(); set++) {
+                for (int way = 0; way < level.wayCount(); way++) {
+                    CacheBlock& block = level.block(set, way);
+                    cout << "Set " << set << " Way " << way << ": Tag = " << level.tagAt(set, way)
+                         << ", Valid = " << block.valid << ", Dirty Mask = 0x" << hex << block.dirtyMask << dec;
+                    if (const int* words = level.line(set, way)) {
+                        cout << ", Data =";
+                        for (int w = 0; w < blockSize; w++) cout << " " << words[w];
+                    }
+                    cout << endl;
+                }
+            }
+        }
+    }
+
+    void printStats() {
+        cout << "\n--- Cache Statistics ---" << endl;
+        for (size_t i = 0; i < levels.size(); i++) {
+            const CacheStats& stats = levels[i].stats;
+            uint64_t accesses = stats.hits + stats.misses;
+            cout << levelName(i) << ": Hits = " << stats.hits << ", Misses = " << stats.misses
+                 << ", Hit Rate = " << (accesses ? 100.0 * stats.hits / accesses : 0.0) << "%"
+                 << ", Evictions = " << stats.evictions << ", Write-Backs = " << stats.writebacks
+                 << " (" << stats.writebackBytes << " Bytes)" << endl;
+        }
+        cout << "Memory: Block Fetches = " << memoryFetches << ", Block Write-Backs = " << memoryWritebacks
+             << ", Read Bytes = " << memoryReadBytes << ", Written Bytes = " << memoryWriteBytes << endl;
+        cout << "Timing: Cycles = " << cycle << ", Read Stall Cycles = " << readStallCycles
+             << ", Write Stall Cycles = " << writeStallCycles << endl;
+        for (size_t i = 0; i < levels.size(); i++) {
+            const PrefetchUnit* unit = prefetchUnits[i].get();
+            if (!unit) continue;
+            const PrefetchStats& stats = unit->stats;
+            uint64_t misses = levels[i].stats.misses;
+            cout << levelName(i) << " Prefetcher (" << prefetchKindName(unit->config.kind) << "): Requested = " << stats.requested
+                 << ", Queue Drops = " << stats.queueDrops << ", Redundant = " << stats.redundant
+                 << ", Issued = " << stats.issued << ", Useful = " << stats.useful << ", Late = " << stats.late << " (" << stats.lateCycles << " Cycles)"
+                 << ", Unused = " << stats.unused << ", Pollution = " << stats.pollution << endl;
+            cout << "    Accuracy = " << (stats.issued ? 100.0 * stats.useful / stats.issued : 0.0)
+                 << "%, Coverage = " << (stats.useful + misses ? 100.0 * stats.useful / (stats.useful + misses) : 0.0)
+                 << "%, Timely = " << (stats.useful ? 100.0 * (stats.useful - stats.late) / stats.useful : 0.0)
+                 << "%, Degree = " << unit->degree << " (Throttled Up " << stats.throttleUps << ", Down "
+                 << stats.throttleDowns << ")" << endl;
+        }
+        if (writePolicy == BufferedWriteThrough) {
+            const WriteBufferStats& stats = writeBufferStats;
+            cout << "Write Buffer: Writes = " << stats.writes << ", Coalesced = " << stats.coalesced
+                 << ", Drains = " << stats.drains << ", Full Stalls = " << stats.fullStalls
+                 << ", Forwarded Reads = " << stats.forwardedReads << ", Conflict Drains = " << stats.conflictDrains << endl;
+        }
+    }
+
+    void printMainMemory() {
+        cout << "\n--- Main Memory Status ---" << endl;
+        for (int i = 0; i < mainMemorySize; i++) {
+            cout << "Address " << i << ": Data = " << mainMemory[i] << endl;
+        }
+    }
 };
 
-// Replacement Policies
-enum ReplacementPolicy {
-    LRU,
-    FIFO,
-    LFU,
-    Random
+//// Multicore Coherence ////
+
+// Protocols of the private caches, named by the states their lines can be in
+enum CoherenceProtocol { MSI, MESI, MOESI };
+
+struct CoherenceStats {
+    uint64_t busReads = 0;           // BusRd: read misses
+    uint64_t busReadExclusives = 0;  // BusRdX: write misses
+    uint64_t busUpgrades = 0;        // BusUpgr: writes to a Shared or Owned line
+    uint64_t busWritebacks = 0;      // Modified or Owned lines leaving a private hierarchy
+    uint64_t snoops = 0;             // Lookups in other cores' caches (snooping: every other core per request)
+    uint64_t directoryMessages = 0;  // Requests, forwards, invalidations, acknowledgements, data and replacement notices
+    uint64_t invalidations = 0;      // Copies removed from other cores
+    uint64_t falseSharing = 0;       // ...whose core had used none of the written words
+    uint64_t staleInvalidations = 0; // Directory invalidations of a line the core had silently dropped
+    uint64_t interventions = 0;      // Misses served by another core's Modified or Owned copy
+    uint64_t flushBytes = 0;         // Dirty bytes written to memory when a Modified line is downgraded
+
+    uint64_t busTransactions() const { return busReads + busReadExclusives + busUpgrades + busWritebacks; }
 };
 
-// Write Policies
-enum WritePolicy {
-    WriteThrough,
-    BufferedWriteThrough,
-    WriteBack
+// Full-map directory: per block, a sharer bit for each core (ceil(cores / 64) words, so any core
+// count fits) and the core holding it Exclusive, Modified or Owned, or -1. Shared lines are
+// dropped silently, so a sharer bit can be stale
+class CoherenceDirectory {
+private:
+    unordered_map<int64_t, uint32_t> entries;
+    vector<int> owners;
+    vector<uint64_t> sharerWords;
+    int words;
+
+public:
+    explicit CoherenceDirectory(int cores = 0) : words((cores + 63) / 64) {}
+
+    // Entry of a block, created empty on first use
+    uint32_t entry(int64_t blockNumber) {
+        auto [position, added] = entries.try_emplace(blockNumber, (uint32_t)owners.size());
+        if (added) {
+            owners.push_back(-1);
+            sharerWords.resize(sharerWords.size() + words, 0);
+        }
+        return position->second;
+    }
+
+    int& owner(uint32_t entry) { return owners[entry]; }
+    uint64_t* sharers(uint32_t entry) { return &sharerWords[(size_t)entry * words]; }
+    int sharerWordCount() const { return words; }
+
+    void addSharer(uint32_t entry, int core) { sharers(entry)[core / 64] |= (uint64_t)1 << (core % 64); }
+    void removeSharer(uint32_t entry, int core) { sharers(entry)[core / 64] &= ~((uint64_t)1 << (core % 64)); }
+    void clearSharers(uint32_t entry) { memset(sharers(entry), 0, words * sizeof(uint64_t)); }
 };
 
-// Mapping Functions
-enum MappingFunction {
-    Direct,
-    Associative,
-    SetAssociative
+// One access of a core, within one block
+struct CoreAccess {
+    uint64_t address;
+    uint32_t size;
+    bool isWrite;
 };
 
-// Cache Coherency Mechanisms
-enum CoherencyMechanism {
-    BusWatching,
-    HardwareTransparency,
-    CacheFlushing
+// Fixed set of worker threads; run() hands out core indices until every core has had its turn
+class CoreThreadPool {
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake, finished;
+    function<void(size_t)> task;
+    size_t tasks = 0;
+    atomic<size_t> nextTask{0};
+    size_t active = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void work() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            for (size_t index; (index = nextTask++) < tasks;) task(index);
+            lock_guard<mutex> guard(lock);
+            if (--active == 0) finished.notify_all();
+        }
+    }
+
+public:
+    // A single thread runs the tasks on the caller's thread, without a worker
+    explicit CoreThreadPool(size_t threads) {
+        for (size_t i = 0; threads > 1 && i < threads; i++) workers.emplace_back([this] { work(); });
+    }
+
+    ~CoreThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers) worker.join();
+    }
+
+    void run(size_t taskCount, const function<void(size_t)>& taskBody) {
+        if (workers.empty()) {
+            for (size_t index = 0; index < taskCount; index++) taskBody(index);
+            return;
+        }
+        unique_lock<mutex> guard(lock);
+        task = taskBody;
+        tasks = taskCount;
+        nextTask = 0;
+        active = workers.size();
+        generation++;
+        wake.notify_all();
+        finished.wait(guard, [&] { return active == 0; });
+    }
 };
 
-// Cache Memory Class
-class CacheMemory {
+// Cores with private write-back hierarchies kept coherent by a snooping bus (BusWatching) or a
+// directory (HardwareTransparency). The caches are tag-only: states and traffic, not data.
+//
+// An access whose line is held with enough permission (any valid state for a read, Exclusive or
+// Modified for a write) stays inside its core's hierarchy; any other goes over the bus, which
+// serves one request at a time and updates the other cores' copies
+class CoherentSystem {
 private:
-    vector<CacheBlock> cache;
-    vector<int> mainMemory; // Simulated DRAM
-    unordered_map<int, int> accessFrequency; // For LFU policy
-    deque<int> fifoQueue; // For FIFO policy
-    vector<bool> nonCacheableMemory; // Tracks non-cacheable memory regions
-    vector<int> writeBuffer; // For Buffered Write-Through
+    struct Core {
+        unique_ptr<CacheMemory> cache;
+        vector<pair<int64_t, uint8_t>> departures; // Blocks that left the hierarchy, not yet seen by the bus
+        uint64_t accesses = 0;
+        uint64_t invalidated = 0;   // Copies other cores' writes took away
+        uint64_t falseSharing = 0;  // ...of which this core had used none of the written words
+    };
 
-    int cacheSize;
+    vector<Core> cores;
+    CoherenceProtocol protocol;
+    CoherencyMechanism mechanism;
+    CoherenceDirectory directory;
     int blockSize;
-    int mainMemorySize;
-    int associativity; // For set-associative mapping
-    ReplacementPolicy replacementPolicy;
-    WritePolicy writePolicy;
-    MappingFunction mappingFunction;
-    CoherencyMechanism coherencyMechanism;
 
-    void fetchBlockFromMemory(int address, int blockNumber, int setIndex, bool isWrite, int writeData);
+    int64_t blockNumberOf(uint64_t address) const { return address / blockSize; }
 
-public:
-    CacheMemory(int cacheSize, int blockSize, int mainMemorySize, int associativity,
-                ReplacementPolicy replacementPolicy, WritePolicy writePolicy,
-                MappingFunction mappingFunction, CoherencyMechanism coherencyMechanism)
-        : cacheSize(cacheSize), blockSize(blockSize), mainMemorySize(mainMemorySize),
-          associativity(associativity), replacementPolicy(replacementPolicy),
-          writePolicy(writePolicy), mappingFunction(mappingFunction),
-          coherencyMechanism(coherencyMechanism) {
-        cache.resize(cacheSize);
-        mainMemory.resize(mainMemorySize, 0); // Initialize main memory
-        nonCacheableMemory.resize(mainMemorySize, false); // Default: all memory cacheable
+    // Take a writer's copy away from core `other`; the line's dirty words pass to the writer
+    void invalidateCopy(int other, int64_t blockNumber, uint64_t writtenBits, uint64_t& inheritedDirty) {
+        uint64_t dirtyMask, usedMask;
+        if (!cores[other].cache->invalidateBlock(blockNumber, dirtyMask, usedMask)) {
+            stats.staleInvalidations++;
+            return;
+        }
+        stats.invalidations++;
+        cores[other].invalidated++;
+        if (!(usedMask & writtenBits)) {
+            stats.falseSharing++;
+            cores[other].falseSharing++;
+        }
+        inheritedDirty |= dirtyMask;
     }
 
-    void markNonCacheableMemory(int start, int end) {
-        for (int i = start; i <= end; i++) {
-            nonCacheableMemory[i] = true;
+    // A BusRd has found another core's copy in `state`: downgrade it. True if it supplied the data
+    bool downgradeCopy(int other, int64_t blockNumber, uint8_t state) {
+        CacheMemory& cache = *cores[other].cache;
+        if (state == ModifiedState && protocol == MOESI) {
+            cache.setCoherenceState(blockNumber, OwnedState);
+        } else if (state == ModifiedState) {
+            stats.flushBytes += cache.flushBlock(blockNumber);
+            cache.setCoherenceState(blockNumber, SharedState);
+        } else if (state == ExclusiveState) {
+            cache.setCoherenceState(blockNumber, SharedState);
         }
+        return state == ModifiedState || state == OwnedState;
     }
 
-    void accessMemory(int address, int writeData = -1, bool isWrite = false) {
-        // Handle Non-Cacheable Memory
-        if (nonCacheableMemory[address]) {
-            cout << "Accessing Non-Cacheable Memory: Address = " << address;
+    // Snooping: every other core looks the block up. Both requests return the requester's new
+    // state, and set supplied when another core's Modified or Owned copy answers; an upgrade (the
+    // requester holds the line) takes no data
+    uint8_t snoopRequest(int core, int64_t blockNumber, bool isWrite, bool upgrade, uint64_t writtenBits,
+                         uint64_t& inheritedDirty, bool& supplied) {
+        bool shared = false;
+        supplied = false;
+        for (int other = 0; other < (int)cores.size(); other++) {
+            if (other == core) continue;
+            stats.snoops++;
+            uint8_t state = cores[other].cache->coherenceState(blockNumber);
+            if (state == InvalidState) continue;
+            shared = true;
             if (isWrite) {
-                mainMemory[address] = writeData;
-                cout << ", Write Data = " << writeData << endl;
+                supplied |= state == ModifiedState || state == OwnedState;
+                invalidateCopy(other, blockNumber, writtenBits, inheritedDirty);
             } else {
-                cout << ", Read Data = " << mainMemory[address] << endl;
+                supplied |= downgradeCopy(other, blockNumber, state);
             }
-            return;
         }
+        if (supplied && !upgrade) stats.interventions++;
+        return isWrite ? ModifiedState : protocol == MSI || shared ? SharedState : ExclusiveState;
+    }
 
-        int blockNumber = address / blockSize;
-        int offset = address % blockSize;
-        int setIndex = blockNumber % cacheSize; // Default for direct mapping
-        if (mappingFunction == Associative) setIndex = 0; // Ignore index for fully associative
-        if (mappingFunction == SetAssociative) setIndex = blockNumber % associativity;
+    // Directory: a read goes to the owner only, a write invalidates every sharer. Each message to
+    // another core is answered (data or acknowledgement), and data comes from memory when no owner
+    // sends it
+    uint8_t directoryRequest(int core, int64_t blockNumber, bool isWrite, bool upgrade, uint64_t writtenBits,
+                             uint64_t& inheritedDirty, bool& supplied) {
+        uint32_t entry = directory.entry(blockNumber);
+        int& owner = directory.owner(entry);
+        supplied = false;
+        uint8_t newState = ModifiedState;
+        stats.directoryMessages++;
 
-        if (cache[setIndex].valid && cache[setIndex].tag == blockNumber) {
-            // Cache Hit
-            cout << "Cache Hit: Address = " << address << ", Data = " << cache[setIndex].data << endl;
-            if (isWrite) {
-                cache[setIndex].data = writeData;
-                if (writePolicy == WriteBack) cache[setIndex].dirty = true;
-                if (writePolicy == WriteThrough) mainMemory[address] = writeData;
-                if (writePolicy == BufferedWriteThrough) writeBuffer.push_back(address);
+        if (isWrite) {
+            uint64_t* sharers = directory.sharers(entry);
+            for (int word = 0; word < directory.sharerWordCount(); word++) {
+                for (uint64_t bits = sharers[word]; bits; bits &= bits - 1) {
+                    int other = word * 64 + lowestSetBit(bits);
+                    if (other == core) continue;
+                    stats.directoryMessages += 2;
+                    uint8_t state = cores[other].cache->coherenceState(blockNumber);
+                    supplied |= state == ModifiedState || state == OwnedState;
+                    invalidateCopy(other, blockNumber, writtenBits, inheritedDirty);
+                }
             }
+            directory.clearSharers(entry);
+            directory.addSharer(entry, core);
+            owner = core;
         } else {
-            // Cache Miss
-            cout << "Cache Miss: Address = " << address << endl;
-
-            // Write-back policy: Write dirty block to memory during eviction
-            if (cache[setIndex].valid && cache[setIndex].dirty && writePolicy == WriteBack) {
-                int mainMemoryAddress = cache[setIndex].tag * blockSize;
-                mainMemory[mainMemoryAddress] = cache[setIndex].data;
-                cout << "Write-Back: Address = " << mainMemoryAddress << ", Data = " << cache[setIndex].data << endl;
+            if (owner >= 0 && owner != core) {
+                stats.directoryMessages += 2;
+                uint8_t state = cores[owner].cache->coherenceState(blockNumber);
+                supplied = downgradeCopy(owner, blockNumber, state);
+                if (cores[owner].cache->coherenceState(blockNumber) != OwnedState) owner = -1;
             }
+            bool shared = false;
+            const uint64_t* sharers = directory.sharers(entry);
+            for (int word = 0; word < directory.sharerWordCount(); word++) {
+                shared |= (sharers[word] & ~(word == core / 64 ? (uint64_t)1 << (core % 64) : 0)) != 0;
+            }
+            directory.addSharer(entry, core);
+            newState = protocol != MSI && !shared ? ExclusiveState : SharedState;
+            if (newState == ExclusiveState) owner = core;
+        }
+        if (upgrade) return newState;
+        if (supplied) stats.interventions++;
+        else stats.directoryMessages++; // Data from memory
+        return newState;
+    }
+
+public:
+    CoherenceStats stats;
 
-            fetchBlockFromMemory(address, blockNumber, setIndex, isWrite, writeData);
+    // Every core gets a private hierarchy of levelConfigs
+    CoherentSystem(int coreCount, const vector<CacheLevelConfig>& levelConfigs, int blockSize,
+                   InclusionPolicy inclusionPolicy, CoherenceProtocol protocol, CoherencyMechanism mechanism)
+        : cores(coreCount), protocol(protocol), mechanism(mechanism), directory(coreCount), blockSize(blockSize) {
+        if (coreCount < 1) throw invalid_argument("a multicore system needs at least one core");
+        if (mechanism == CacheFlushing) {
+            throw invalid_argument("cache flushing is software coherence; use bus watching or hardware transparency");
+        }
+        for (const CacheLevelConfig& config : levelConfigs) {
+            if (config.replacementPolicy == Random) {
+                throw invalid_argument("random replacement draws from one generator shared by the cores' threads");
+            }
+        }
+        for (Core& core : cores) {
+            core.cache.reset(new CacheMemory(levelConfigs, blockSize, 0, inclusionPolicy, WriteBack, mechanism));
+            vector<pair<int64_t, uint8_t>>& departures = core.departures;
+            core.cache->onDeparture = [&departures](int64_t blockNumber, uint8_t state) {
+                departures.push_back({blockNumber, state});
+            };
         }
+    }
+
+    int coreCount() const { return cores.size(); }
+    const CacheMemory& cache(int core) const { return *cores[core].cache; }
 
-        // Replacement policies
-        if (replacementPolicy == LFU) accessFrequency[blockNumber]++;
-        if (replacementPolicy == FIFO) fifoQueue.push_back(blockNumber);
+    // Serve an access from the core's own hierarchy if it holds the line with enough permission;
+    // false (and nothing done) if the access needs the bus. Touches only that core, so the cores'
+    // local accesses can run in parallel
+    bool localAccess(int core, uint64_t address, bool isWrite, int size) {
+        CacheMemory& cache = *cores[core].cache;
+        int64_t blockNumber = blockNumberOf(address);
+        uint8_t state = cache.coherenceState(blockNumber);
+        if (isWrite ? state != ModifiedState && state != ExclusiveState : state == InvalidState) return false;
+        if (state == ExclusiveState && isWrite) cache.setCoherenceState(blockNumber, ModifiedState); // Silent upgrade
+        cache.accessMemory<LogOff>(address, 0, isWrite, size);
+        cores[core].accesses++;
+        return true;
     }
 
-    void fetchBlockFromMemory(int address, int blockNumber, int setIndex, bool isWrite, int writeData) {
-        int blockStartAddress = blockNumber * blockSize;
-        cache[setIndex].tag = blockNumber;
-        cache[setIndex].valid = true;
-        cache[setIndex].dirty = false; // Reset dirty bit
-        cache[setIndex].data = mainMemory[blockStartAddress];
-        cout << "Fetched Block: Address = " << blockStartAddress << ", Data = " << cache[setIndex].data << endl;
+    // An access that needs the bus: one request, served before any other
+    void busAccess(int core, uint64_t address, bool isWrite, int size) {
+        CacheMemory& cache = *cores[core].cache;
+        int64_t blockNumber = blockNumberOf(address);
+        uint8_t state = cache.coherenceState(blockNumber);
+        uint64_t writtenBits = isWrite ? cache.accessBits(address, size) : 0;
+        if (!isWrite) stats.busReads++;
+        else if (state == InvalidState) stats.busReadExclusives++;
+        else stats.busUpgrades++;
 
-        if (isWrite) {
-            cache[setIndex].data = writeData; // Write data to the block
-            if (writePolicy == WriteBack) cache[setIndex].dirty = true;
+        uint64_t inheritedDirty = 0;
+        bool upgrade = state != InvalidState, supplied;
+        uint8_t newState = mechanism == BusWatching
+                               ? snoopRequest(core, blockNumber, isWrite, upgrade, writtenBits, inheritedDirty, supplied)
+                               : directoryRequest(core, blockNumber, isWrite, upgrade, writtenBits, inheritedDirty, supplied);
+        cache.suppliedByCache = supplied && !upgrade; // The miss is filled cache to cache
+        cache.accessMemory<LogOff>(address, 0, isWrite, size);
+        cache.setCoherenceState(blockNumber, newState);
+        if (inheritedDirty) cache.markDirty(blockNumber, inheritedDirty);
+        cores[core].accesses++;
+        retireDepartures(core);
+    }
+
+    // Tell the bus about lines that left a core's hierarchy: Modified and Owned ones were written
+    // back; the directory also hears of Exclusive ones (Shared ones leave silently)
+    void retireDepartures(int core) {
+        for (auto [blockNumber, state] : cores[core].departures) {
+            if (state == ModifiedState || state == OwnedState) stats.busWritebacks++;
+            if (mechanism != HardwareTransparency || state == SharedState || state == InvalidState) continue;
+            uint32_t entry = directory.entry(blockNumber);
+            stats.directoryMessages++;
+            directory.removeSharer(entry, core);
+            if (directory.owner(entry) == core) directory.owner(entry) = -1;
         }
+        cores[core].departures.clear();
     }
 
-    void flushCache() {
-        cout << "\nFlushing Cache..." << endl;
-        for (int i = 0; i < cacheSize; i++) {
-            if (cache[i].valid && cache[i].dirty && writePolicy == WriteBack) {
-                int mainMemoryAddress = cache[i].tag * blockSize;
-                mainMemory[mainMemoryAddress] = cache[i].data;
-                cout << "Flushed Dirty Block: Address = " << mainMemoryAddress << ", Data = " << cache[i].data << endl;
-                cache[i].dirty = false;
+    // Run every core's accesses in rounds. Each round, the cores run in parallel, each up to
+    // `quantum` accesses its own hierarchy can serve, stopping at the first that needs the bus.
+    // Then the bus serves the stopped cores in order of their access counts, lower core first on
+    // ties. The result does not depend on the thread count or on thread timing
+    void run(const vector<vector<CoreAccess>>& traces, int threads, int quantum = 1024) {
+        vector<size_t> next(cores.size(), 0);
+        vector<char> waiting(cores.size(), 0);
+        CoreThreadPool pool(min<size_t>(max(threads, 1), cores.size()));
+        while (true) {
+            pool.run(cores.size(), [&](size_t core) {
+                const vector<CoreAccess>& trace = traces[core];
+                for (int ran = 0; next[core] < trace.size() && ran < quantum; ran++) {
+                    const CoreAccess& access = trace[next[core]];
+                    if (!localAccess(core, access.address, access.isWrite, access.size)) {
+                        waiting[core] = 1;
+                        break;
+                    }
+                    next[core]++;
+                }
+            });
+
+            bool done = true;
+            vector<int> requests;
+            for (size_t core = 0; core < cores.size(); core++) {
+                retireDepartures(core);
+                if (waiting[core]) requests.push_back(core);
+                done &= next[core] == traces[core].size();
+            }
+            if (done) break;
+            sort(requests.begin(), requests.end(), [&](int a, int b) {
+                return cores[a].accesses != cores[b].accesses ? cores[a].accesses < cores[b].accesses : a < b;
+            });
+            for (int core : requests) {
+                const CoreAccess& access = traces[core][next[core]];
+                busAccess(core, access.address, access.isWrite, access.size);
+                next[core]++;
+                waiting[core] = 0;
             }
         }
     }
 
-    void printCacheStatus() {
-        cout << "\n--- Cache Status ---" << endl;
-        for (int i = 0; i < cacheSize; i++) {
-            cout << "Cache Block " << i << ": Tag = " << cache[i].tag << ", Data = " << cache[i].data
-                 << ", Valid = " << cache[i].valid << ", Dirty = " << cache[i].dirty << endl;
+    // Write every dirty line back, as the bus would at the end of a run
+    void flush() {
+        for (size_t core = 0; core < cores.size(); core++) {
+            cores[core].cache->flushCache<LogOff>();
+            retireDepartures(core);
         }
     }
 
-    void printMainMemory() {
-        cout << "\n--- Main Memory Status ---" << endl;
-        for (int i = 0; i < mainMemorySize; i++) {
-            cout << "Address " << i << ": Data = " << mainMemory[i] << endl;
+    void printStats() {
+        static const char* protocolNames[] = {"MSI", "MESI", "MOESI"};
+        cout << "\n--- Coherence Statistics (" << protocolNames[protocol] << ", "
+             << (mechanism == BusWatching ? "Snooping" : "Directory") << ", " << cores.size() << " Cores) ---" << endl;
+        for (size_t core = 0; core < cores.size(); core++) {
+            const CacheMemory& cache = *cores[core].cache;
+            const CacheStats& l1 = cache.levelStats(0);
+            cout << "Core " << core << ": Accesses = " << cores[core].accesses << ", L1 Misses = " << l1.misses
+                 << ", Memory Fetches = " << cache.memoryFetches << ", Cache-to-Cache Fills = " << cache.cacheToCacheFills
+                 << ", Invalidated = " << cores[core].invalidated
+                 << " (False Sharing = " << cores[core].falseSharing << ")" << endl;
+        }
+        cout << "Bus Transactions = " << stats.busTransactions() << " (BusRd = " << stats.busReads
+             << ", BusRdX = " << stats.busReadExclusives << ", BusUpgr = " << stats.busUpgrades
+             << ", Write-Backs = " << stats.busWritebacks << ")" << endl;
+        cout << "Invalidations = " << stats.invalidations << " (False Sharing = " << stats.falseSharing
+             << "), Interventions = " << stats.interventions << ", Flushed Bytes = " << stats.flushBytes << endl;
+        if (mechanism == BusWatching) cout << "Snoop Lookups = " << stats.snoops << endl;
+        else cout << "Directory Messages = " << stats.directoryMessages << ", Stale Invalidations = " << stats.staleInvalidations << endl;
+    }
+};
+
+//// Trace Replay ////
+
+// Two binary trace formats, each starting with an 8-byte magic. Integers are little-endian.
+//
+// "CTRACE01" (fixed, replayed from a memory map): flags (uint32, bit 0 = records carry a thread
+// id), reserved (uint32), then records of address (uint64), kind (uint8, 0 = read, 1 = write),
+// size in bytes (uint8) and, with thread ids, thread (uint16). 10 or 12 bytes per record.
+//
+// "CTRACEV1" (varint-delta, streamed, so it can come from a pipe): each record starts with a
+// flagged varint. Its first byte holds the flags in bits 0-2 (write, size follows, thread follows)
+// and the low 4 bits of zigzag(address - previous address) in bits 3-6; every continuation byte
+// (bit 7 of the previous byte set) adds 7 more bits. The new size and the new thread follow as
+// plain varints when they changed. Address, size and thread all start at 0.
+
+struct TraceRecord {
+    uint64_t address;
+    uint32_t size;
+    uint16_t thread;
+    bool isWrite;
+};
+
+const char fixedTraceMagic[9] = "CTRACE01";
+const char varintTraceMagic[9] = "CTRACEV1";
+
+enum TraceFlag : uint8_t { TraceWrite = 1, TraceSizeFollows = 2, TraceThreadFollows = 4 };
+
+// Fixed-record trace over a memory map
+class FixedTraceReader {
+private:
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+    size_t recordSize = 10;
+    bool hasThreads = false;
+
+public:
+    bool truncated = false;
+
+    // False unless the mapped bytes start with the fixed-trace header
+    bool open(const MappedFile& file) {
+        if (file.size < 16 || memcmp(file.data, fixedTraceMagic, 8) != 0) return false;
+        uint32_t flags;
+        memcpy(&flags, file.data + 8, 4);
+        hasThreads = flags & 1;
+        recordSize = hasThreads ? 12 : 10;
+        cursor = reinterpret_cast<const uint8_t*>(file.data) + 16;
+        end = reinterpret_cast<const uint8_t*>(file.data) + file.size;
+        truncated = (end - cursor) % recordSize != 0;
+        return true;
+    }
+
+    bool next(TraceRecord& record) {
+        if ((size_t)(end - cursor) < recordSize) return false;
+        memcpy(&record.address, cursor, 8);
+        record.isWrite = cursor[8] & 1;
+        record.size = cursor[9];
+        record.thread = 0;
+        if (hasThreads) memcpy(&record.thread, cursor + 10, 2);
+        cursor += recordSize;
+        return true;
+    }
+};
+
+// Varint-delta trace streamed through a fixed buffer
+class VarintTraceReader {
+private:
+    static const size_t maxRecordBytes = 10 + 5 + 3; // Flagged address varint, size varint, thread varint
+
+    istream& in;
+    vector<uint8_t> buffer;
+    size_t position = 0, filled = 0;
+    bool endOfInput = false;
+    uint64_t address = 0;
+    uint32_t size = 0;
+    uint16_t thread = 0;
+
+    // Keep at least maxRecordBytes ahead of the cursor until the input runs out
+    void refill() {
+        memmove(buffer.data(), buffer.data() + position, filled - position);
+        filled -= position;
+        position = 0;
+        in.read(reinterpret_cast<char*>(buffer.data() + filled), buffer.size() - maxRecordBytes - filled);
+        filled += in.gcount();
+        if (!in) endOfInput = true;
+        memset(buffer.data() + filled, 0, maxRecordBytes); // A truncated record reads zeros, not stale bytes
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = buffer[position++];
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        return value;
+    }
+
+public:
+    bool truncated = false;
+
+    explicit VarintTraceReader(istream& in, size_t capacity = 1 << 20)
+        : in(in), buffer(capacity + maxRecordBytes, 0) {}
+
+    // False unless the stream starts with the varint-trace magic
+    bool open() {
+        char magic[8];
+        if (!in.read(magic, 8) || memcmp(magic, varintTraceMagic, 8) != 0) return false;
+        refill();
+        return true;
+    }
+
+    bool next(TraceRecord& record) {
+        if (filled - position < maxRecordBytes && !endOfInput) refill();
+        if (position >= filled) return false;
+
+        uint8_t byte = buffer[position++];
+        uint8_t flags = byte & 7;
+        uint64_t zigzag = (byte >> 3) & 15;
+        for (int shift = 4; (byte & 0x80) && shift < 64; shift += 7) {
+            byte = buffer[position++];
+            zigzag |= (uint64_t)(byte & 0x7f) << shift;
+        }
+        address += (zigzag >> 1) ^ (0 - (zigzag & 1));
+        if (flags & TraceSizeFollows) size = readVarint();
+        if (flags & TraceThreadFollows) thread = readVarint();
+        if (position > filled) {
+            truncated = true;
+            return false;
+        }
+
+        record.address = address;
+        record.size = size;
+        record.thread = thread;
+        record.isWrite = flags & TraceWrite;
+        return true;
+    }
+};
+
+// Encodes records in either format
+class TraceWriter {
+private:
+    ostream& out;
+    bool varint;
+    bool hasThreads;
+    vector<uint8_t> buffer;
+    uint64_t address = 0;
+    uint32_t size = 0;
+    uint16_t thread = 0;
+
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back((uint8_t)value);
+    }
+
+public:
+    TraceWriter(ostream& out, bool varint, bool hasThreads) : out(out), varint(varint), hasThreads(hasThreads) {
+        if (varint) {
+            out.write(varintTraceMagic, 8);
+        } else {
+            uint32_t header[2] = {hasThreads ? 1u : 0u, 0};
+            out.write(fixedTraceMagic, 8);
+            out.write(reinterpret_cast<const char*>(header), 8);
+        }
+    }
+    ~TraceWriter() { flush(); }
+
+    void write(const TraceRecord& record) {
+        if (varint) {
+            uint64_t delta = record.address - address;
+            uint64_t zigzag = (delta << 1) ^ (0 - (delta >> 63));
+            uint8_t flags = (record.isWrite ? TraceWrite : 0) | (record.size != size ? TraceSizeFollows : 0) |
+                            (record.thread != thread ? TraceThreadFollows : 0);
+            uint8_t first = flags | (uint8_t)((zigzag & 15) << 3);
+            zigzag >>= 4;
+            buffer.push_back(zigzag ? first | 0x80 : first);
+            if (zigzag) putVarint(zigzag);
+            if (flags & TraceSizeFollows) putVarint(record.size);
+            if (flags & TraceThreadFollows) putVarint(record.thread);
+            address = record.address;
+            size = record.size;
+            thread = record.thread;
+        } else {
+            uint8_t bytes[12];
+            memcpy(bytes, &record.address, 8);
+            bytes[8] = record.isWrite;
+            bytes[9] = (uint8_t)record.size;
+            memcpy(bytes + 10, &record.thread, 2);
+            buffer.insert(buffer.end(), bytes, bytes + (hasThreads ? 12 : 10));
         }
+        if (buffer.size() >= (1 << 16)) flush();
+    }
+
+    void flush() {
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        buffer.clear();
     }
 };
 
-int main() {
+// Counts of one replay
+struct TraceSummary {
+    uint64_t records = 0;
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t blockAccesses = 0; // An access straddling a block boundary touches every block it covers
+    double seconds = 0;
+};
+
+// Call visit(address, bytes) for the part of a record inside each block it touches (a power-of-two
+// block size), counting the record and its block accesses
+template <typename Visit>
+inline void splitAtBlocks(const TraceRecord& record, uint64_t blockSize, TraceSummary& summary, Visit visit) {
+    summary.records++;
+    if (record.isWrite) summary.writes++;
+    else summary.reads++;
+
+    uint64_t address = record.address, remaining = record.size ? record.size : 1;
+    do {
+        uint64_t bytes = min(remaining, blockSize - (address & (blockSize - 1)));
+        visit(address, bytes);
+        summary.blockAccesses++;
+        address += bytes;
+        remaining -= bytes;
+    } while (remaining);
+}
+
+void printTraceSummary(const TraceSummary& summary) {
+    cout << "Records = " << summary.records << " (Reads = " << summary.reads << ", Writes = " << summary.writes
+         << "), Block Accesses = " << summary.blockAccesses << "\n";
+    cout << "Time = " << summary.seconds << " s, Accesses/s = "
+         << (uint64_t)(summary.blockAccesses / max(summary.seconds, 1e-9)) << "\n";
+}
+
+// Feed every record of a trace to the cache, with per-access logging compiled out. The block size
+// must be a power of two
+template <typename Reader>
+TraceSummary replayTrace(CacheMemory& cache, Reader& reader) {
+    TraceSummary summary;
+    uint64_t blockSize = cache.getBlockSize();
+    auto start = chrono::steady_clock::now();
+
+    TraceRecord record;
+    while (reader.next(record)) {
+        splitAtBlocks(record, blockSize, summary, [&](uint64_t address, uint64_t bytes) {
+            cache.accessMemory<LogOff>(address, 0, record.isWrite, bytes);
+        });
+    }
+
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+// Give each record to core (thread id % cores), then run the system. Only the run is timed
+template <typename Reader>
+TraceSummary replayMulticoreTrace(CoherentSystem& system, Reader& reader, int threads, int quantum) {
+    TraceSummary summary;
+    uint64_t blockSize = system.cache(0).getBlockSize();
+    vector<vector<CoreAccess>> traces(system.coreCount());
+
+    TraceRecord record;
+    while (reader.next(record)) {
+        vector<CoreAccess>& trace = traces[record.thread % system.coreCount()];
+        splitAtBlocks(record, blockSize, summary, [&](uint64_t address, uint64_t bytes) {
+            trace.push_back({address, (uint32_t)bytes, record.isWrite});
+        });
+    }
+
+    auto start = chrono::steady_clock::now();
+    system.run(traces, threads, quantum);
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+// Open a trace, fixed or varint ("-": varint on standard input), and pass its reader to body.
+// False, after printing why, if it is not a readable trace
+template <typename Body>
+bool withTraceReader(const string& tracePath, Body body) {
+    MappedFile file;
+    FixedTraceReader fixedReader;
+    ifstream stream;
+    if (tracePath != "-" && !file.open(tracePath)) {
+        cerr << "Error: cannot open " << tracePath << "\n";
+        return false;
+    }
+    bool truncated;
+    if (tracePath != "-" && fixedReader.open(file)) {
+        body(fixedReader);
+        truncated = fixedReader.truncated;
+    } else {
+        if (tracePath != "-") stream.open(tracePath, ios::binary);
+        VarintTraceReader varintReader(tracePath == "-" ? cin : stream);
+        if (!varintReader.open()) {
+            cerr << "Error: not a cache trace: " << tracePath << "\n";
+            return false;
+        }
+        body(varintReader);
+        truncated = varintReader.truncated;
+    }
+    if (truncated) cerr << "Warning: trace ends in a partial record\n";
+    return true;
+}
+
+// Text trace ("address r|w [size] [thread]" per line, address decimal or 0x hex) to a binary one
+bool encodeTrace(const string& inputPath, const string& outputPath, bool varint) {
+    ifstream input(inputPath);
+    ofstream output(outputPath, ios::binary);
+    if (!input || !output) {
+        cerr << "Error: cannot open " << (!input ? inputPath : outputPath) << "\n";
+        return false;
+    }
+
+    // Thread ids are only stored when the trace has any
+    vector<TraceRecord> records;
+    bool hasThreads = false;
+    string line;
+    for (size_t lineNumber = 1; getline(input, line); lineNumber++) {
+        if (line.empty() || line[0] == '#') continue;
+        char kind = 0;
+        unsigned long long address = 0;
+        unsigned size = 4, thread = 0;
+        char addressText[32];
+        int fields = sscanf(line.c_str(), "%31s %c %u %u", addressText, &kind, &size, &thread);
+        char* endOfAddress;
+        address = strtoull(addressText, &endOfAddress, 0);
+        if (fields < 2 || *endOfAddress != '\0' || (kind != 'r' && kind != 'w') || size > 255 || thread > 65535) {
+            cerr << "Error: malformed record on line " << lineNumber << ": " << line << "\n";
+            return false;
+        }
+        records.push_back({address, size, (uint16_t)thread, kind == 'w'});
+        hasThreads |= thread != 0;
+    }
+
+    TraceWriter writer(output, varint, hasThreads);
+    for (const TraceRecord& record : records) writer.write(record);
+    return true;
+}
+
+// Parse a "blocks:ways[:policy]" level description
+bool parseLevelConfig(const string& text, CacheLevelConfig& config) {
+    unsigned blocks = 0, ways = 0;
+    char policy[16] = "lru";
+    if (sscanf(text.c_str(), "%u:%u:%15s", &blocks, &ways, policy) < 2 || blocks == 0 || ways == 0) return false;
+    string name = policy;
+    if (name == "lru") config.replacementPolicy = LRU;
+    else if (name == "fifo") config.replacementPolicy = FIFO;
+    else if (name == "lfu") config.replacementPolicy = LFU;
+    else if (name == "random") config.replacementPolicy = Random;
+    else if (name == "plru") config.replacementPolicy = PseudoLRU;
+    else return false;
+    config.cacheSize = blocks;
+    config.associativity = ways;
+    config.mappingFunction = ways == 1 ? Direct : ways == blocks ? Associative : SetAssociative;
+    return true;
+}
+
+// Parse a "level:kind[:degree]" prefetcher description (level 1 is L1)
+bool parsePrefetchConfig(const string& text, size_t& level, PrefetcherConfig& config) {
+    unsigned number = 0;
+    char kind[16] = "";
+    int degree = config.degree;
+    if (sscanf(text.c_str(), "%u:%15[a-z]:%d", &number, kind, &degree) < 2 || number == 0 || degree < 1) return false;
+    string name = kind;
+    if (name == "nextline") config.kind = PrefetchNextLine;
+    else if (name == "stride") config.kind = PrefetchStride;
+    else if (name == "stream") config.kind = PrefetchStream;
+    else if (name == "delta") config.kind = PrefetchDelta;
+    else return false;
+    level = number - 1;
+    config.degree = degree;
+    config.maxDegree = max(config.maxDegree, degree);
+    return true;
+}
+
+// Parse a whole --replay count as an integer in [1, high]; no sign, blanks or zero
+bool parseReplayCount(const string& text, int high, int& value) {
+    if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+    errno = 0;
+    char* end;
+    unsigned long long parsed = strtoull(text.c_str(), &end, 10);
+    if (errno || *end || parsed < 1 || parsed > (unsigned long long)high) return false;
+    value = (int)parsed;
+    return true;
+}
+
+// Cache --replay trace [--block bytes] [--level blocks:ways[:policy]]... [--inclusion inclusive|exclusive|noninclusive]
+//                      [--write writeback|writethrough|buffered] [--buffer entries:high:low:idle] [--conflict forward|drain]
+//                      [--prefetch level:nextline|stride|stream|delta[:degree]]... [--throttle on|off]
+//                      [--cores n [--protocol msi|mesi|moesi] [--coherence snoop|directory] [--threads t] [--quantum q]]
+// The trace is "-" for a varint trace on standard input. With --cores, each core has the levels as
+// its private write-back hierarchy and runs the records of the trace threads routed to it. Traces
+// carry no PC, so a stride or delta prefetcher sees every access as one PC's
+int runTraceReplay(int argc, char* argv[]) {
+    string tracePath = argv[2];
+    int blockSize = 64;
+    vector<CacheLevelConfig> levelConfigs;
+    InclusionPolicy inclusionPolicy = Inclusive;
+    WritePolicy writePolicy = WriteBack;
+    WriteBufferConfig bufferConfig;
+    int cores = 0, quantum = 1024;
+    int threads = max(1u, thread::hardware_concurrency()); // --threads n runs every core on its own thread
+    CoherenceProtocol protocol = MESI;
+    CoherencyMechanism mechanism = BusWatching;
+    vector<pair<size_t, PrefetcherConfig>> prefetchers;
+    bool throttle = true;
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+        string option = argv[i], value = argv[i + 1];
+        CacheLevelConfig config;
+        PrefetcherConfig prefetch;
+        size_t level;
+        if (option == "--block" && parseReplayCount(value, 1 << 20, blockSize)) {}
+        else if (option == "--level" && parseLevelConfig(value, config)) levelConfigs.push_back(config);
+        else if (option == "--inclusion" && value == "inclusive") inclusionPolicy = Inclusive;
+        else if (option == "--inclusion" && value == "exclusive") inclusionPolicy = Exclusive;
+        else if (option == "--inclusion" && value == "noninclusive") inclusionPolicy = NonInclusive;
+        else if (option == "--write" && value == "writeback") writePolicy = WriteBack;
+        else if (option == "--write" && value == "writethrough") writePolicy = WriteThrough;
+        else if (option == "--write" && value == "buffered") writePolicy = BufferedWriteThrough;
+        else if (option == "--buffer" && sscanf(value.c_str(), "%d:%d:%d:%d", &bufferConfig.entries, &bufferConfig.highWatermark,
+                                                &bufferConfig.lowWatermark, &bufferConfig.idleCycles) >= 1) {}
+        else if (option == "--conflict" && value == "forward") bufferConfig.drainOnReadConflict = false;
+        else if (option == "--conflict" && value == "drain") bufferConfig.drainOnReadConflict = true;
+        else if (option == "--prefetch" && parsePrefetchConfig(value, level, prefetch)) prefetchers.push_back({level, prefetch});
+        else if (option == "--throttle" && (value == "on" || value == "off")) throttle = value == "on";
+        else if (option == "--cores" && parseReplayCount(value, 1024, cores)) {}
+        else if (option == "--protocol" && value == "msi") protocol = MSI;
+        else if (option == "--protocol" && value == "mesi") protocol = MESI;
+        else if (option == "--protocol" && value == "moesi") protocol = MOESI;
+        else if (option == "--coherence" && value == "snoop") mechanism = BusWatching;
+        else if (option == "--coherence" && value == "directory") mechanism = HardwareTransparency;
+        else if (option == "--threads" && parseReplayCount(value, 4096, threads)) {}
+        else if (option == "--quantum" && parseReplayCount(value, 1 << 24, quantum)) {}
+        else {
+            cerr << "Error: bad option " << option << " " << value << "\n";
+            cerr << "Usage: Cache --replay trace [--block 1-2^20] [--cores 1-1024] [--threads 1-4096] [--quantum 1-2^24] ...\n";
+            return 1;
+        }
+    }
+    if (blockSize <= 0 || (blockSize & (blockSize - 1))) {
+        cerr << "Error: block size must be a power of two\n";
+        return 1;
+    }
+    if (cores > 0 && writePolicy != WriteBack) {
+        cerr << "Error: coherent private caches are write-back\n";
+        return 1;
+    }
+    if (cores > 0 && !prefetchers.empty()) {
+        cerr << "Error: prefetchers are single-core only\n";
+        return 1;
+    }
+    // Default: 32 KiB 8-way L1, 256 KiB 8-way L2 and, for a single core, 2 MiB 16-way L3 (at
+    // 64-byte blocks)
+    if (levelConfigs.empty()) {
+        levelConfigs = {{512, 8, SetAssociative, LRU}, {4096, 8, SetAssociative, PseudoLRU}};
+        if (cores == 0) levelConfigs.push_back({32768, 16, SetAssociative, PseudoLRU});
+    }
+
+    try {
+        if (cores > 0) {
+            CoherentSystem system(cores, levelConfigs, blockSize, inclusionPolicy, protocol, mechanism);
+            TraceSummary summary;
+            if (!withTraceReader(tracePath, [&](auto& reader) {
+                    summary = replayMulticoreTrace(system, reader, threads, quantum);
+                })) {
+                return 1;
+            }
+            system.flush();
+            printTraceSummary(summary);
+            system.printStats();
+            return 0;
+        }
+
+        CacheMemory cache(levelConfigs, blockSize, 0, inclusionPolicy, writePolicy, BusWatching);
+        cache.configureWriteBuffer(bufferConfig);
+        for (auto& [level, config] : prefetchers) {
+            config.throttle = throttle;
+            cache.configurePrefetcher(level, config);
+        }
+        TraceSummary summary;
+        if (!withTraceReader(tracePath, [&](auto& reader) { summary = replayTrace(cache, reader); })) return 1;
+        cache.flushCache<LogOff>();
+
+        printTraceSummary(summary);
+        cache.printStats();
+    } catch (const invalid_argument& error) {
+        cerr << "Error: " << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Trace mode: Cache --replay trace [options], Cache --encode text trace [fixed|varint]
+    if (argc > 2 && string(argv[1]) == "--replay") return runTraceReplay(argc, argv);
+    if (argc > 3 && string(argv[1]) == "--encode") {
+        return encodeTrace(argv[2], argv[3], argc > 4 && string(argv[4]) == "varint") ? 0 : 1;
+    }
+
     srand(static_cast<unsigned>(time(0))); // Seed for random replacement policy
 
     CacheMemory cacheMemory(
@@ -207,5 +2398,38 @@ int main() {
     cacheMemory.printCacheStatus();
     cacheMemory.printMainMemory();
 
+    // Three-level exclusive hierarchy: L1 2-way, L2 4-way victim cache, L3 fully associative
+    cout << "\n--- Three-Level Exclusive Hierarchy ---" << endl;
+    CacheMemory hierarchy(
+        {{4, 2, SetAssociative, LRU}, {8, 4, SetAssociative, PseudoLRU}, {16, 16, Associative, LFU}},
+        16, 1024, Exclusive, WriteBack, BusWatching);
+
+    for (int address : {0, 16, 64, 128, 0, 192, 256, 16, 64}) hierarchy.accessMemory(address);
+    hierarchy.accessMemory(128, 7, true);
+    for (int address : {320, 384, 448, 0, 512, 128}) hierarchy.accessMemory(address);
+
+    hierarchy.flushCache();
+    hierarchy.printStats();
+
+    // Sequential scan with a stream prefetcher in L2: most of its misses become prefetch hits
+    CacheMemory scanned({{4, 2, SetAssociative, LRU}, {16, 4, SetAssociative, LRU}}, 16, 4096, Inclusive, WriteBack,
+                        BusWatching);
+    PrefetcherConfig prefetch;
+    prefetch.kind = PrefetchStream;
+    prefetch.degree = 4;
+    scanned.configurePrefetcher(1, prefetch);
+    for (int address = 0; address < 4096; address++) scanned.accessMemory<LogOff>(address);
+    scanned.printStats();
+
+    // Two cores writing neighbouring words of one 16-byte line: each write invalidates the other's copy
+    vector<vector<CoreAccess>> traces(2);
+    for (int i = 0; i < 4; i++) {
+        traces[0].push_back({0, 4, true});
+        traces[1].push_back({4, 4, true});
+    }
+    CoherentSystem system(2, {{4, 2, SetAssociative, LRU}}, 16, Inclusive, MESI, BusWatching);
+    system.run(traces, 2, 1); // One access per core per round, so the writes interleave
+    system.printStats();
+
     return 0;
 }
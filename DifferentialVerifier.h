@@ -0,0 +1,258 @@
+#ifndef DIFFERENTIAL_VERIFIER_H
+#define DIFFERENTIAL_VERIFIER_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <stdexcept>
+
+//// Differential Verification Engine ////
+
+// Checks a multiplier implementation against native multiplication over width-bit signed operands,
+// either exhaustively or by random sampling, with the operand space sharded across threads.
+// Compute is any callable (int64_t multiplicand, int64_t multiplier, int width) -> __int128 product,
+// and must be safe to call from several threads at once.
+
+struct Mismatch {
+    int64_t multiplicand;
+    int64_t multiplier;
+    int width;
+    __int128 expected;
+    __int128 actual;
+    uint64_t index; // Position in the enumeration order, so reports are the same on any thread count
+};
+
+struct VerificationReport {
+    std::string name;
+    int width = 0;
+    bool exhaustive = false;
+    uint64_t checked = 0;
+    uint64_t mismatches = 0;
+    std::vector<Mismatch> first;   // Earliest mismatches in enumeration order
+    std::vector<Mismatch> reduced; // The same, shrunk to minimal reproducers
+    double seconds = 0;
+};
+
+inline std::string int128ToString(__int128 value) {
+    if (value == 0) return "0";
+    bool negative = value < 0;
+    unsigned __int128 magnitude = negative ? -(unsigned __int128)value : (unsigned __int128)value;
+    std::string digits;
+    while (magnitude) {
+        digits.push_back('0' + (int)(magnitude % 10));
+        magnitude /= 10;
+    }
+    if (negative) digits.push_back('-');
+    std::reverse(digits.begin(), digits.end());
+    return digits;
+}
+
+// MSB-first Two's Complement binary to its value (an empty vector is 0)
+inline __int128 binaryToInt128(const std::vector<bool>& binary) {
+    __int128 value = 0;
+    for (size_t i = 0; i < binary.size(); i++) value = value * 2 + binary[i];
+    if (!binary.empty() && binary[0] && binary.size() < 128) value -= (__int128)1 << binary.size();
+    return value;
+}
+
+// Width-bit MSB-first Two's Complement binary of a value
+inline std::vector<bool> operandToBinary(int64_t value, int width) {
+    std::vector<bool> binary(width);
+    for (int i = 0; i < width; i++) binary[width - 1 - i] = (value >> std::min(i, 63)) & 1;
+    return binary;
+}
+
+// Smallest and largest width-bit Two's Complement values
+inline int64_t minOperand(int width) { return -((int64_t)1 << (width - 1)); }
+inline int64_t maxOperand(int width) { return ((int64_t)1 << (width - 1)) - 1; }
+
+// Parse a whole --verify argument as an unsigned integer in [low, high]; no sign or blanks
+inline bool parseVerificationArgument(const char* text, uint64_t low, uint64_t high, uint64_t& value) {
+    if (text[0] < '0' || text[0] > '9') return false;
+    errno = 0;
+    char* end;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (errno || *end || parsed < low || parsed > high) return false;
+    value = parsed;
+    return true;
+}
+
+// Bits needed to hold a value in Two's Complement
+inline int bitsNeeded(int64_t value) {
+    int width = 1;
+    while (value < minOperand(width) || value > maxOperand(width)) width++;
+    return width;
+}
+
+// Greedily shrink a failing case: operands toward 0, +-1 and half their magnitude, then the width
+// down to what the operands need, keeping each step only while the case still fails
+template <typename Compute>
+Mismatch shrinkMismatch(const Mismatch& failure, Compute& compute) {
+    Mismatch best = failure;
+    auto fails = [&](int64_t a, int64_t b, int width, Mismatch& out) {
+        if (width < 1 || width > 62 || a < minOperand(width) || a > maxOperand(width) ||
+            b < minOperand(width) || b > maxOperand(width)) return false;
+        __int128 expected = (__int128)a * b, actual = compute(a, b, width);
+        if (actual == expected) return false;
+        out = {a, b, width, expected, actual, failure.index};
+        return true;
+    };
+    auto size = [](int64_t a, int64_t b) { return std::llabs(a) + std::llabs(b); };
+
+    for (bool improved = true; improved;) {
+        improved = false;
+        const int64_t a = best.multiplicand, b = best.multiplier;
+        const std::vector<std::pair<int64_t, int64_t>> candidates = {
+            {0, b}, {a, 0}, {1, b}, {a, 1}, {-1, b}, {a, -1}, {a / 2, b}, {a, b / 2},
+            {a - (a > 0) + (a < 0), b}, {a, b - (b > 0) + (b < 0)}};
+        for (const auto& candidate : candidates) {
+            Mismatch next;
+            if (size(candidate.first, candidate.second) < size(best.multiplicand, best.multiplier) &&
+                fails(candidate.first, candidate.second, best.width, next)) {
+                best = next;
+                improved = true;
+                break;
+            }
+        }
+        int smallest = std::max(bitsNeeded(best.multiplicand), bitsNeeded(best.multiplier));
+        for (int width = smallest; !improved && width < best.width; width++) {
+            Mismatch next;
+            if (fails(best.multiplicand, best.multiplier, width, next)) {
+                best = next;
+                improved = true;
+            }
+        }
+    }
+    return best;
+}
+
+// Shared driver: shards [0, total) into blocks handed out to worker threads; check(index) verifies
+// one case and returns true on a match, filling the mismatch otherwise
+template <typename Check>
+void runSharded(uint64_t total, size_t threads, size_t maxReported, Check check, VerificationReport& report) {
+    const uint64_t blockSize = 1 << 16;
+    uint64_t blocks = (total + blockSize - 1) / blockSize;
+    std::atomic<uint64_t> nextBlock(0), checked(0), mismatches(0);
+    std::mutex reportMutex;
+
+    auto worker = [&]() {
+        std::vector<Mismatch> local;
+        uint64_t localChecked = 0, localMismatches = 0;
+        for (uint64_t block; (block = nextBlock++) < blocks;) {
+            uint64_t end = std::min(total, (block + 1) * blockSize);
+            for (uint64_t index = block * blockSize; index < end; index++) {
+                Mismatch mismatch;
+                if (!check(index, mismatch)) {
+                    localMismatches++;
+                    if (local.size() < maxReported) local.push_back(mismatch);
+                }
+            }
+            localChecked += end - block * blockSize;
+        }
+        checked += localChecked;
+        mismatches += localMismatches;
+        std::lock_guard<std::mutex> lock(reportMutex);
+        report.first.insert(report.first.end(), local.begin(), local.end());
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < std::max<size_t>(1, threads); i++) pool.emplace_back(worker);
+    for (std::thread& t : pool) t.join();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    report.checked = checked;
+    report.mismatches = mismatches;
+    std::sort(report.first.begin(), report.first.end(),
+              [](const Mismatch& x, const Mismatch& y) { return x.index < y.index; });
+    if (report.first.size() > maxReported) report.first.resize(maxReported);
+}
+
+// Widest exhaustive check: 2^32 pairs. Wider ones would not finish, and from 32 bits the pair count
+// no longer fits 64 bits
+const int maxExhaustiveWidth = 16;
+
+// Every operand pair at the given width (2^(2 * width) cases), 1 to maxExhaustiveWidth bits
+template <typename Compute>
+VerificationReport verifyExhaustive(const std::string& name, int width, Compute compute, size_t threads,
+                                    size_t maxReported = 5) {
+    if (width < 1 || width > maxExhaustiveWidth) {
+        throw std::invalid_argument("exhaustive verification covers 1 to " + std::to_string(maxExhaustiveWidth) +
+                                    " bits, not " + std::to_string(width));
+    }
+    VerificationReport report;
+    report.name = name;
+    report.width = width;
+    report.exhaustive = true;
+    uint64_t span = (uint64_t)1 << width;
+    runSharded(span * span, threads, maxReported, [&](uint64_t index, Mismatch& mismatch) {
+        int64_t a = minOperand(width) + (int64_t)(index / span);
+        int64_t b = minOperand(width) + (int64_t)(index % span);
+        __int128 expected = (__int128)a * b, actual = compute(a, b, width);
+        if (actual == expected) return true;
+        mismatch = {a, b, width, expected, actual, index};
+        return false;
+    }, report);
+    for (const Mismatch& mismatch : report.first) report.reduced.push_back(shrinkMismatch(mismatch, compute));
+    return report;
+}
+
+// SplitMix64: a cheap stateless hash, so any case can be generated on its own
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Random operand pairs at the given width (up to 62 bits); case i is hashed from (seed, i), so the sample set
+// does not depend on the thread count. The extreme values are always included
+template <typename Compute>
+VerificationReport verifyRandom(const std::string& name, int width, uint64_t samples, Compute compute, size_t threads,
+                                uint64_t seed = 1, size_t maxReported = 5) {
+    VerificationReport report;
+    report.name = name;
+    report.width = width;
+    const int64_t edges[] = {minOperand(width), minOperand(width) + 1, -1, 0, 1, maxOperand(width)};
+    runSharded(samples + 36, threads, maxReported, [&](uint64_t index, Mismatch& mismatch) {
+        int64_t a, b;
+        if (index < 36) {
+            a = edges[index / 6];
+            b = edges[index % 6];
+        } else {
+            uint64_t mask = ((uint64_t)1 << width) - 1;
+            a = minOperand(width) + (int64_t)(splitMix64(seed * 0x100000001B3ULL + 2 * index) & mask);
+            b = minOperand(width) + (int64_t)(splitMix64(seed * 0x100000001B3ULL + 2 * index + 1) & mask);
+        }
+        __int128 expected = (__int128)a * b, actual = compute(a, b, width);
+        if (actual == expected) return true;
+        mismatch = {a, b, width, expected, actual, index};
+        return false;
+    }, report);
+    for (const Mismatch& mismatch : report.first) report.reduced.push_back(shrinkMismatch(mismatch, compute));
+    return report;
+}
+
+inline void printVerificationReport(const VerificationReport& report, std::ostream& out = std::cout) {
+    out << report.name << " @ " << report.width << " bits (" << (report.exhaustive ? "exhaustive" : "random")
+        << "): " << report.checked << " pairs in " << report.seconds << " s, "
+        << (uint64_t)(report.checked / std::max(report.seconds, 1e-9)) << " pairs/s, "
+        << report.mismatches << " mismatches\n";
+    for (size_t k = 0; k < report.first.size(); k++) {
+        const Mismatch& m = report.first[k];
+        const Mismatch& r = report.reduced[k];
+        out << "  " << m.multiplicand << " * " << m.multiplier << " = " << int128ToString(m.expected)
+            << ", got " << int128ToString(m.actual) << "; minimal: " << r.multiplicand << " * " << r.multiplier
+            << " @ " << r.width << " bits = " << int128ToString(r.expected) << ", got " << int128ToString(r.actual) << "\n";
+    }
+}
+
+#endif
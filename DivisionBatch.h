@@ -0,0 +1,430 @@
+#ifndef DIVISION_BATCH_H
+#define DIVISION_BATCH_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "DivisionEngine.h"
+
+//// Batch Division Service ////
+
+// Streams (dividend, divisor, width) records from a text file, divides them on a thread pool and
+// writes the results as columns. Every record gets a status, so bad input is reported per record
+// instead of producing undefined output.
+//
+// Input: one record per line, "dividend divisor [width]". A missing or 0 width means the exact
+// width the operands need; blank lines and lines starting with '#' are skipped.
+//
+// Output: "DIVCOLS1", then blocks of up to blockRecords results, each a record count (4 bytes)
+// followed by the columns quotient (int64), remainder (int64), width (uint8) and status (uint8),
+// in host byte order. Results are in input order.
+
+enum DivisionStatus : uint8_t {
+    DivisionOk,
+    DivisionByZero,   // divisor == 0
+    OperandOverflow,  // an operand does not fit the given width
+    QuotientOverflow, // -2^(width-1) / -1, the quotient does not fit the width
+    MalformedRecord   // unparsable line, or width above 64
+};
+
+const int divisionStatusCount = 5;
+
+inline std::string divisionStatusName(DivisionStatus status) {
+    switch (status) {
+    case DivisionOk: return "OK";
+    case DivisionByZero: return "Division By Zero";
+    case OperandOverflow: return "Operand Overflow";
+    case QuotientOverflow: return "Quotient Overflow";
+    case MalformedRecord: return "Malformed Record";
+    }
+    return "Unknown";
+}
+
+inline bool parseDivisionMode(const std::string& name, DivisionMode& mode) {
+    if (name == "restoring") mode = RestoringMode;
+    else if (name == "nonrestoring") mode = NonRestoringMode;
+    else if (name == "srt") mode = SRTRadix4Mode;
+    else if (name == "newton") mode = NewtonRaphsonMode;
+    else if (name == "goldschmidt") mode = GoldschmidtMode;
+    else return false;
+    return true;
+}
+
+// Smallest Two's Complement width holding value (0 and -1 need 1 bit, 1 needs 2)
+inline size_t exactOperandWidth(int64_t value) {
+    uint64_t magnitude = value < 0 ? ~(uint64_t)value : (uint64_t)value;
+    return magnitude ? 64 - __builtin_clzll(magnitude) + 1 : 1;
+}
+
+// Exact width for a division: both operands fit, and so does the quotient (-2^(w-1) / -1 needs
+// one bit more)
+inline size_t exactDivisionWidth(int64_t dividend, int64_t divisor) {
+    size_t width = std::max(exactOperandWidth(dividend), exactOperandWidth(divisor));
+    if (divisor == -1 && width < 64 && dividend == -((int64_t)1 << (width - 1))) width++;
+    return width;
+}
+
+struct DivisionRecord {
+    int64_t dividend = 0, divisor = 0;
+    uint32_t width = 0; // 0: exact width from the operands
+    bool malformed = false;
+};
+
+struct DivisionColumns {
+    std::vector<int64_t> quotient, remainder;
+    std::vector<uint8_t> width, status;
+
+    void resize(size_t count) {
+        quotient.resize(count);
+        remainder.resize(count);
+        width.resize(count);
+        status.resize(count);
+    }
+};
+
+// Parse a decimal int64 at cursor, stopping before end; false on no digits or overflow
+inline bool parseDivisionInteger(const char*& cursor, const char* end, int64_t& value) {
+    bool negative = cursor < end && *cursor == '-';
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) cursor++;
+    const char* digits = cursor;
+    uint64_t magnitude = 0, limit = negative ? (uint64_t)1 << 63 : ((uint64_t)1 << 63) - 1;
+    for (; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++) {
+        uint64_t digit = *cursor - '0';
+        if (magnitude > (limit - digit) / 10) return false;
+        magnitude = magnitude * 10 + digit;
+    }
+    value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return cursor != digits;
+}
+
+// Parse one line; returns false for lines that hold no record (blank or comment)
+inline bool parseDivisionRecord(const char* line, const char* end, DivisionRecord& record) {
+    auto isSeparator = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == ','; };
+    while (line < end && isSeparator(*line)) line++;
+    if (line == end || *line == '#') return false;
+    record = DivisionRecord();
+    int64_t fields[3] = {0, 0, 0};
+    int count = 0;
+    while (true) {
+        while (line < end && isSeparator(*line)) line++;
+        if (line == end) break;
+        if (count == 3 || !parseDivisionInteger(line, end, fields[count]) || (line < end && !isSeparator(*line))) {
+            record.malformed = true;
+            return true;
+        }
+        count++;
+    }
+    if (count < 2 || fields[2] < 0 || fields[2] > 64) {
+        record.malformed = true;
+        return true;
+    }
+    record.dividend = fields[0];
+    record.divisor = fields[1];
+    record.width = (uint32_t)fields[2];
+    return true;
+}
+
+// Divide one record through the engine; quotient and remainder are 0 unless the status is OK
+inline DivisionStatus divideRecord(const DivisionRecord& record, DivisionMode mode,
+                                   int64_t& quotient, int64_t& remainder, uint8_t& width) {
+    quotient = remainder = 0;
+    width = 0;
+    if (record.malformed) return MalformedRecord;
+    size_t needed = std::max(exactOperandWidth(record.dividend), exactOperandWidth(record.divisor));
+    size_t w = record.width ? record.width : exactDivisionWidth(record.dividend, record.divisor);
+    width = (uint8_t)w;
+    if (needed > w) return OperandOverflow;
+    if (record.divisor == 0) return DivisionByZero;
+
+    bool dividendNegative = record.dividend < 0, divisorNegative = record.divisor < 0;
+    uint64_t n = dividendNegative ? 0 - (uint64_t)record.dividend : (uint64_t)record.dividend;
+    uint64_t d = divisorNegative ? 0 - (uint64_t)record.divisor : (uint64_t)record.divisor;
+    divideWordMagnitudes(n, d, w, mode);
+
+    // Sign correction: the quotient truncates toward zero, the remainder takes the dividend's sign
+    __int128 q = dividendNegative != divisorNegative ? -(__int128)n : (__int128)n;
+    if (q > ((__int128)1 << (w - 1)) - 1) return QuotientOverflow;
+    quotient = (int64_t)q;
+    remainder = dividendNegative ? -(int64_t)d : (int64_t)d;
+    return DivisionOk;
+}
+
+// Fixed set of worker threads; run() hands out block indices until all are done and returns when
+// every block has finished
+class DivisionThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    std::function<void(size_t)> task;
+    size_t blocks = 0;
+    std::atomic<size_t> nextBlock{0};
+    size_t active = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void work() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            for (size_t block; (block = nextBlock++) < blocks;) task(block);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) finished.notify_all();
+        }
+    }
+
+public:
+    explicit DivisionThreadPool(size_t threads) {
+        for (size_t i = 0; i < std::max<size_t>(1, threads); i++) workers.emplace_back([this] { work(); });
+    }
+
+    ~DivisionThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    void run(size_t blockCount, std::function<void(size_t)> blockTask) {
+        std::unique_lock<std::mutex> lock(mutex);
+        task = std::move(blockTask);
+        blocks = blockCount;
+        nextBlock = 0;
+        active = workers.size();
+        generation++;
+        wake.notify_all();
+        finished.wait(lock, [&] { return active == 0; });
+    }
+};
+
+struct BatchDivisionStats {
+    size_t records = 0;
+    size_t byStatus[divisionStatusCount] = {};
+    double seconds = 0;
+};
+
+inline void writeDivisionBlock(std::ostream& out, const DivisionColumns& columns, size_t count) {
+    uint32_t header = (uint32_t)count;
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)columns.quotient.data(), count * sizeof(int64_t));
+    out.write((const char*)columns.remainder.data(), count * sizeof(int64_t));
+    out.write((const char*)columns.width.data(), count);
+    out.write((const char*)columns.status.data(), count);
+}
+
+inline BatchDivisionStats runBatchDivision(std::istream& in, std::ostream& out, DivisionMode mode,
+                                           size_t threads, size_t blockRecords = 1 << 16) {
+    const size_t shardRecords = 4096;
+    BatchDivisionStats stats;
+    DivisionThreadPool pool(threads);
+    std::vector<DivisionRecord> records;
+    records.reserve(blockRecords);
+    DivisionColumns columns;
+    std::vector<std::array<size_t, divisionStatusCount>> shardCounts;
+    auto start = std::chrono::steady_clock::now();
+    out.write("DIVCOLS1", 8);
+
+    auto flushBlock = [&]() {
+        size_t count = records.size();
+        if (!count) return;
+        columns.resize(count);
+        size_t shards = (count + shardRecords - 1) / shardRecords;
+        shardCounts.assign(shards, {});
+        pool.run(shards, [&](size_t shard) {
+            size_t end = std::min(count, (shard + 1) * shardRecords);
+            for (size_t k = shard * shardRecords; k < end; k++) {
+                DivisionStatus status = divideRecord(records[k], mode, columns.quotient[k], columns.remainder[k], columns.width[k]);
+                columns.status[k] = status;
+                shardCounts[shard][status]++;
+            }
+        });
+        for (const auto& counts : shardCounts) {
+            for (int s = 0; s < divisionStatusCount; s++) stats.byStatus[s] += counts[s];
+        }
+        writeDivisionBlock(out, columns, count);
+        stats.records += count;
+        records.clear();
+    };
+
+    // Read in large chunks and parse every complete line; a partial last line waits for the next chunk
+    std::vector<char> chunk(1 << 20);
+    std::string pending;
+    DivisionRecord record;
+    while (in) {
+        in.read(chunk.data(), chunk.size());
+        size_t got = in.gcount();
+        if (!got) break;
+        pending.append(chunk.data(), got);
+        size_t lineStart = 0;
+        for (size_t newline; (newline = pending.find('\n', lineStart)) != std::string::npos; lineStart = newline + 1) {
+            if (parseDivisionRecord(pending.data() + lineStart, pending.data() + newline, record)) {
+                records.push_back(record);
+                if (records.size() == blockRecords) flushBlock();
+            }
+        }
+        pending.erase(0, lineStart);
+    }
+    if (parseDivisionRecord(pending.data(), pending.data() + pending.size(), record)) records.push_back(record);
+    flushBlock();
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+inline void printBatchDivisionStats(const BatchDivisionStats& stats, std::ostream& out = std::cout) {
+    out << "Records: " << stats.records << " in " << stats.seconds << " s ("
+        << (stats.seconds > 0 ? stats.records / stats.seconds / 1e6 : 0) << " M divisions/s)\n";
+    for (int s = 0; s < divisionStatusCount; s++) {
+        if (stats.byStatus[s]) out << divisionStatusName((DivisionStatus)s) << ": " << stats.byStatus[s] << "\n";
+    }
+}
+
+// Print a columnar result file as text rows; returns false if it is not one or is truncated
+inline bool printDivisionColumns(std::istream& in, std::ostream& out = std::cout) {
+    char magic[8];
+    if (!in.read(magic, 8) || std::string(magic, 8) != "DIVCOLS1") return false;
+    out << "Record | Quotient | Remainder | Width | Status\n";
+    DivisionColumns columns;
+    size_t index = 0;
+    uint32_t count;
+    while (in.read((char*)&count, sizeof(count))) {
+        columns.resize(count);
+        if (!in.read((char*)columns.quotient.data(), count * sizeof(int64_t)) ||
+            !in.read((char*)columns.remainder.data(), count * sizeof(int64_t)) ||
+            !in.read((char*)columns.width.data(), count) || !in.read((char*)columns.status.data(), count)) return false;
+        for (size_t k = 0; k < count; k++, index++) {
+            out << index << " | " << columns.quotient[k] << " | " << columns.remainder[k] << " | "
+                << (int)columns.width[k] << " | " << divisionStatusName((DivisionStatus)columns.status[k]) << "\n";
+        }
+    }
+    return true;
+}
+
+//// Division Command Line ////
+
+// Parse a whole command-line argument as an integer in [low, high]
+inline bool parseDivisionArgument(const char* text, int64_t low, int64_t high, int64_t& value) {
+    const char* end = text + std::strlen(text);
+    return parseDivisionInteger(text, end, value) && text == end && value >= low && value <= high;
+}
+
+// The modes shared by the bit-serial division programs:
+//   --bench                                  every engine mode, prepared divisors, trace levels
+//   --batch input output [threads] [mode]    columnar batch division (batchMode by default)
+//   --columns file                           print a columnar result file
+//   --trace file dividend divisor            record the full binary trace of one division
+//   --replay file                            pretty-print a recorded trace
+// tracedDivide is the program's division, as in runTraceLevelBenchmark. Returns false when argv
+// names none of these, leaving the program to run interactively; otherwise status is the exit code
+template <typename TracedDivide>
+inline bool runDivisionCli(int argc, char* argv[], TracedDivide tracedDivide, DivisionMode batchMode, int& status) {
+    std::string command = argc > 1 ? argv[1] : "";
+    status = 1;
+
+    // Benchmark mode: compare every division engine mode across widths, then batch division by
+    // prepared divisors against per-element division, then the cost of each trace level
+    if (command == "--bench") {
+        runDivisionBenchmark();
+        std::cout << "\n";
+        runPreparedDivisionBenchmark();
+        std::cout << "\n";
+        runTraceLevelBenchmark(tracedDivide);
+        status = 0;
+        return true;
+    }
+
+    // Batch mode: divide every record of an input file on a thread pool into a columnar result file
+    if (argc > 3 && command == "--batch") {
+        int64_t threads = std::max(1u, std::thread::hardware_concurrency());
+        if (argc > 4 && !parseDivisionArgument(argv[4], 1, 4096, threads)) {
+            std::cerr << "Error: thread count must be between 1 and 4096: " << argv[4] << "\n";
+            return true;
+        }
+        DivisionMode mode = batchMode;
+        if (argc > 5 && !parseDivisionMode(argv[5], mode)) {
+            std::cerr << "Error: unknown mode " << argv[5] << " (restoring, nonrestoring, srt, newton, goldschmidt)\n";
+            return true;
+        }
+        std::ifstream input(argv[2], std::ios::binary);
+        std::ofstream output(argv[3], std::ios::binary);
+        if (!input || !output) {
+            std::cerr << "Error: cannot open " << (!input ? argv[2] : argv[3]) << "\n";
+            return true;
+        }
+        BatchDivisionStats stats = runBatchDivision(input, output, mode, threads);
+        std::cout << divisionModeName(mode) << " on " << threads << " threads\n";
+        printBatchDivisionStats(stats);
+        status = 0;
+        return true;
+    }
+
+    // Columns mode: print a columnar result file as text
+    if (argc > 2 && command == "--columns") {
+        std::ifstream file(argv[2], std::ios::binary);
+        if (!file || !printDivisionColumns(file)) {
+            std::cerr << "Error: not a columnar result file or truncated: " << argv[2] << "\n";
+            return true;
+        }
+        status = 0;
+        return true;
+    }
+
+    // Record mode: write the full binary trace of one division to a file
+    if (argc > 4 && command == "--trace") {
+        int64_t dividend, divisor;
+        if (!parseDivisionArgument(argv[3], INT32_MIN, INT32_MAX, dividend) ||
+            !parseDivisionArgument(argv[4], INT32_MIN, INT32_MAX, divisor)) {
+            std::cerr << "Error: operands must be 32-bit signed integers\n";
+            return true;
+        }
+        if (divisor == 0) {
+            std::cerr << "Error: division by zero\n";
+            return true;
+        }
+        int bitWidth = std::max<int>(8, exactDivisionWidth(dividend, divisor));
+        std::ofstream file(argv[2], std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: cannot open " << argv[2] << "\n";
+            return true;
+        }
+        DivisionTraceSink sink(file);
+        tracedDivide(TraceLevelTag<TraceFull>(), (int)dividend, (int)divisor, bitWidth, &sink);
+        status = 0;
+        return true;
+    }
+
+    // Replay mode: pretty-print a recorded trace
+    if (argc > 2 && command == "--replay") {
+        std::ifstream file(argv[2], std::ios::binary);
+        if (!file || !replayDivisionTrace(file)) {
+            std::cerr << "Error: unreadable or truncated trace: " << argv[2] << "\n";
+            return true;
+        }
+        status = 0;
+        return true;
+    }
+
+    return false;
+}
+
+#endif
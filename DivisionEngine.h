@@ -0,0 +1,1060 @@
+#ifndef DIVISION_ENGINE_H
+#define DIVISION_ENGINE_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <list>
+#include <map>
+#include <sstream>
+#include <type_traits>
+#include "PackedRegister.h"
+
+//// Division Engine ////
+
+// Restoring, non-restoring, SRT radix-4, Newton-Raphson and Goldschmidt division behind one API,
+// all on registers packed into 64-bit words (word 0 holds bits 0-63). Every mode divides the
+// magnitudes and then applies the signs: the quotient truncates toward zero and the remainder
+// takes the sign of the dividend, as in C.
+
+enum DivisionMode { RestoringMode, NonRestoringMode, SRTRadix4Mode, NewtonRaphsonMode, GoldschmidtMode };
+
+inline std::string divisionModeName(DivisionMode mode) {
+    switch (mode) {
+    case RestoringMode: return "Restoring";
+    case NonRestoringMode: return "Non-Restoring";
+    case SRTRadix4Mode: return "SRT Radix-4";
+    case NewtonRaphsonMode: return "Newton-Raphson";
+    case GoldschmidtMode: return "Goldschmidt";
+    }
+    return "Unknown";
+}
+
+typedef std::vector<uint64_t> Words;
+
+struct DivisionResult {
+    std::vector<bool> quotient;  // width-bit Two's Complement, MSB first
+    std::vector<bool> remainder; // width-bit Two's Complement, MSB first
+    size_t iterations = 0;       // Recurrence steps (plus correction steps for the reciprocal modes)
+    bool divisionByZero = false; // Quotient and remainder are left 0
+};
+
+//// Word Arithmetic ////
+
+// Unsigned little-endian word vectors. Unless noted, both operands have the same length and
+// results wrap modulo 2^(64 * length); a set top bit reads as negative where a mode needs signs
+
+inline bool isNegativeWords(const Words& x) { return x.back() >> 63; }
+
+inline bool isZeroWords(const Words& x) {
+    for (uint64_t word : x) {
+        if (word) return false;
+    }
+    return true;
+}
+
+inline bool bitAt(const Words& x, size_t position) {
+    return position / 64 < x.size() && ((x[position / 64] >> (position % 64)) & 1);
+}
+
+// The 64 bits starting at position (zeros past the end)
+inline uint64_t bitsFrom(const Words& x, size_t position) {
+    size_t word = position / 64, bit = position % 64;
+    uint64_t low = word < x.size() ? x[word] >> bit : 0;
+    if (bit && word + 1 < x.size()) low |= x[word + 1] << (64 - bit);
+    return low;
+}
+
+inline void setBit(Words& x, size_t position) { x[position / 64] |= (uint64_t)1 << (position % 64); }
+
+inline size_t bitLengthWords(const Words& x) {
+    for (size_t i = x.size(); i-- > 0;) {
+        if (x[i]) return 64 * i + 64 - __builtin_clzll(x[i]);
+    }
+    return 0;
+}
+
+// Unsigned comparison: -1, 0 or 1
+inline int compareWords(const Words& x, const Words& y) {
+    for (size_t i = x.size(); i-- > 0;) {
+        if (x[i] != y[i]) return x[i] < y[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// x += y, returns the carry out
+inline uint64_t addWords(Words& x, const Words& y) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        unsigned __int128 t = (unsigned __int128)x[i] + y[i] + carry;
+        x[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    return carry;
+}
+
+// x -= y, returns the borrow out
+inline uint64_t subtractWords(Words& x, const Words& y) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        uint64_t diff = x[i] - y[i] - borrow;
+        borrow = (x[i] < y[i]) || (x[i] - y[i] < borrow);
+        x[i] = diff;
+    }
+    return borrow;
+}
+
+inline void addSmallWords(Words& x, uint64_t value) {
+    for (size_t i = 0; i < x.size() && value; i++) {
+        x[i] += value;
+        value = x[i] < value;
+    }
+}
+
+inline void negateWords(Words& x) {
+    uint64_t carry = 1;
+    for (uint64_t& word : x) {
+        word = ~word + carry;
+        carry = carry && word == 0;
+    }
+}
+
+// x <<= shift and x >>= shift (logical), any shift
+inline void shiftLeftWords(Words& x, size_t shift) {
+    size_t wordShift = shift / 64, bitShift = shift % 64;
+    for (size_t i = x.size(); i-- > 0;) {
+        uint64_t word = i >= wordShift ? x[i - wordShift] << bitShift : 0;
+        if (bitShift && i > wordShift) word |= x[i - wordShift - 1] >> (64 - bitShift);
+        x[i] = word;
+    }
+}
+
+inline void shiftRightWords(Words& x, size_t shift) {
+    size_t wordShift = shift / 64, bitShift = shift % 64;
+    for (size_t i = 0; i < x.size(); i++) {
+        uint64_t word = i + wordShift < x.size() ? x[i + wordShift] >> bitShift : 0;
+        if (bitShift && i + wordShift + 1 < x.size()) word |= x[i + wordShift + 1] << (64 - bitShift);
+        x[i] = word;
+    }
+}
+
+// (x << 1) | in, returns the bit shifted out of the top
+inline bool shiftLeftOneWords(Words& x, bool in) {
+    uint64_t carry = in;
+    for (uint64_t& word : x) {
+        uint64_t out = word >> 63;
+        word = (word << 1) | carry;
+        carry = out;
+    }
+    return carry;
+}
+
+// Schoolbook product, truncated to length words
+inline Words multiplyWords(const Words& x, const Words& y, size_t length) {
+    Words product(length, 0);
+    for (size_t i = 0; i < x.size() && i < length; i++) {
+        if (!x[i]) continue;
+        uint64_t carry = 0;
+        for (size_t j = 0; j < y.size() && i + j < length; j++) {
+            unsigned __int128 t = (unsigned __int128)x[i] * y[j] + product[i + j] + carry;
+            product[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        if (i + y.size() < length) product[i + y.size()] = carry;
+    }
+    return product;
+}
+
+// Clear every bit from position width up
+inline void maskWords(Words& x, size_t width) {
+    for (size_t i = 0; i < x.size(); i++) {
+        if (64 * i >= width) {
+            x[i] = 0;
+        } else if (64 * (i + 1) > width) {
+            x[i] &= ~(uint64_t)0 >> (64 * (i + 1) - width);
+        }
+    }
+}
+
+inline Words resizedWords(Words x, size_t length) {
+    x.resize(length, 0);
+    return x;
+}
+
+//// Division Modes ////
+
+// Each mode takes magnitudes n and d (d != 0) of at most width bits, in words of the same
+// length, and leaves the quotient and remainder there; it returns its iteration count
+
+// Restoring: shift (A, Q) left, subtract M from A, and add it back if A went negative
+inline size_t restoringDivide(Words& n, Words& d, size_t width) {
+    size_t length = n.size() + 1; // A holds width + 1 bits, so A - M is never misread
+    Words A(length, 0), M = resizedWords(d, length), Q = n;
+    for (size_t i = 0; i < width; i++) {
+        shiftLeftOneWords(A, bitAt(Q, width - 1));
+        shiftLeftOneWords(Q, 0);
+        subtractWords(A, M);
+        if (isNegativeWords(A)) {
+            addWords(A, M); // Restore
+        } else {
+            setBit(Q, 0);
+        }
+    }
+    maskWords(Q, width);
+    n = Q;
+    d = resizedWords(A, n.size());
+    return width;
+}
+
+// Non-restoring: A stays negative instead of being restored, and the next step adds M back
+// shifted; one correction add at the end
+inline size_t nonRestoringDivide(Words& n, Words& d, size_t width) {
+    size_t length = n.size() + 1;
+    Words A(length, 0), M = resizedWords(d, length), Q = n;
+    for (size_t i = 0; i < width; i++) {
+        bool wasNegative = isNegativeWords(A);
+        shiftLeftOneWords(A, bitAt(Q, width - 1));
+        shiftLeftOneWords(Q, 0);
+        if (wasNegative) {
+            addWords(A, M);
+        } else {
+            subtractWords(A, M);
+        }
+        if (!isNegativeWords(A)) setBit(Q, 0);
+    }
+    if (isNegativeWords(A)) addWords(A, M);
+    maskWords(Q, width);
+    n = Q;
+    d = resizedWords(A, n.size());
+    return width + 1;
+}
+
+// SRT radix-4 quotient-digit selection table, digits {-2..2}, redundancy rho = 2/3. It is indexed
+// by the divisor's top 4 bits (normalized d in [1/2, 1), so 8..15) and 4P truncated to 1/8
+// (-22..21, offset by 32). A digit is valid for a cell when every reachable (r, d) in it
+// (|r| <= 8/3 d) keeps |r - q d| <= 2/3 d. Both sides are linear, so it is enough to check the
+// corners of the reachable part of the cell; the table is derived from that rule rather than typed in
+struct SRTTable {
+    int8_t digit[16][64];
+    bool complete = true; // Every reachable cell has a valid digit
+
+    SRTTable() {
+        for (int dTop = 8; dTop < 16; dTop++) {
+            for (int r = -32; r < 32; r++) {
+                digit[dTop][r + 32] = 0;
+                double dLow = dTop / 16.0, dHigh = (dTop + 1) / 16.0, rLow = r / 8.0, rHigh = (r + 1) / 8.0;
+                std::vector<std::pair<double, double>> corners; // (r, d)
+                for (double d : {dLow, dHigh}) {
+                    for (double x : {rLow, rHigh, 8 * d / 3, -8 * d / 3}) corners.push_back({x, d});
+                }
+                for (double x : {rLow, rHigh}) corners.push_back({x, 3 * std::fabs(x) / 8});
+                std::vector<std::pair<double, double>> reachable;
+                for (const auto& c : corners) {
+                    const double eps = 1e-12;
+                    if (c.first >= rLow - eps && c.first <= rHigh + eps && c.second >= dLow - eps && c.second <= dHigh + eps &&
+                        3 * std::fabs(c.first) <= 8 * c.second + eps) reachable.push_back(c);
+                }
+                if (reachable.empty()) continue;
+
+                bool found = false;
+                for (int q = -2; q <= 2 && !found; q++) {
+                    found = true;
+                    for (const auto& c : reachable) {
+                        if (std::fabs(c.first - q * c.second) > 2 * c.second / 3 + 1e-12) found = false;
+                    }
+                    if (found) digit[dTop][r + 32] = q;
+                }
+                complete = complete && found;
+            }
+        }
+    }
+};
+
+// SRT radix-4: normalize d to D' (top bit at bit W - 1), then run P = 4P - q D'' from P = N 2^s
+// with D'' = D' 4^m, choosing each signed digit q from the table on a few top bits of P and D'.
+// Positive and negative digits collect in separate registers (Q = Q+ - Q-), with a final
+// correction if P ends negative
+inline size_t srtRadix4Divide(Words& n, Words& d, size_t width) {
+    static const SRTTable table;
+    size_t W = std::max<size_t>(width, 4);
+    size_t s = W - bitLengthWords(d);
+    size_t m = (s + 3) / 2; // |P0| <= 2^(W+s) / 4^m <= D'' / 2, inside the 2/3 bound
+    size_t length = (W + 2 * m + 4) / 64 + 2; // A spare word keeps the estimate's sign in word 0
+    Words P = resizedWords(n, length), D = resizedWords(d, length);
+    shiftLeftWords(P, s);
+    shiftLeftWords(D, s); // D' for now, to read its top 4 bits
+    Words top = D;
+    shiftRightWords(top, W - 4);
+    size_t dTop = top[0];
+    shiftLeftWords(D, 2 * m);
+
+    Words twiceD = D, QPlus(length, 0), QMinus(length, 0);
+    shiftLeftOneWords(twiceD, 0);
+    size_t estimateShift = W + 2 * m - 5; // 4P truncated to 1/8 of the D'' scale
+    for (size_t j = 0; j < m; j++) {
+        int r = (int)(int64_t)bitsFrom(P, estimateShift); // The bits above the estimate are its sign
+        int q = table.digit[dTop][r + 32];
+
+        shiftLeftWords(P, 2);
+        shiftLeftWords(QPlus, 2);
+        shiftLeftWords(QMinus, 2);
+        if (q > 0) {
+            subtractWords(P, q == 2 ? twiceD : D);
+            addSmallWords(QPlus, q);
+        } else if (q < 0) {
+            addWords(P, q == -2 ? twiceD : D);
+            addSmallWords(QMinus, -q);
+        }
+    }
+
+    // P = 4^m (N 2^s - Q D'), so the remainder is P >> (2m + s)
+    subtractWords(QPlus, QMinus);
+    size_t iterations = m;
+    if (isNegativeWords(P)) {
+        addWords(P, D);
+        subtractWords(QPlus, resizedWords(Words{1}, length));
+        iterations++;
+    }
+    shiftRightWords(P, 2 * m + s);
+    n = resizedWords(QPlus, n.size());
+    d = resizedWords(P, n.size());
+    return iterations;
+}
+
+// Fix a quotient estimate q (within a few units of the truth) against n = q d + r; returns the
+// number of correction steps
+inline size_t correctQuotient(const Words& n, const Words& d, Words& q, Words& r) {
+    size_t length = q.size(), steps = 0;
+    r = resizedWords(n, length);
+    subtractWords(r, multiplyWords(resizedWords(d, length), q, length));
+    Words D = resizedWords(d, length), one = resizedWords(Words{1}, length);
+    while (isNegativeWords(r)) {
+        addWords(r, D);
+        subtractWords(q, one);
+        steps++;
+    }
+    while (compareWords(r, D) >= 0) {
+        subtractWords(r, D);
+        addWords(q, one);
+        steps++;
+    }
+    return steps;
+}
+
+// About 8 bits of 2^(2W) / D' from the top 9 bits of D' (256..511)
+inline Words initialReciprocal(const Words& D, size_t W, size_t length) {
+    Words top = D;
+    shiftRightWords(top, W - 9);
+    uint64_t estimate = ((uint64_t)1 << 18) / (top[0] + 1) + 1; // 2^9 / d at 9 fraction bits, rounded up
+    Words Y = resizedWords(Words{estimate}, length);
+    shiftLeftWords(Y, W - 9);
+    return Y;
+}
+
+// Newton-Raphson: Y ~ 2^(2W) / D' refined by Y += Y (2^(2W) - D' Y) / 2^(2W), doubling the
+// correct bits each step from an 8-bit table seed; then q = N 2^s Y / 2^(2W) and a correction
+inline size_t newtonRaphsonDivide(Words& n, Words& d, size_t width) {
+    size_t W = std::max<size_t>(width, 16);
+    size_t s = W - bitLengthWords(d);
+    size_t length = (4 * W + 8) / 64 + 2;
+    Words D = resizedWords(d, length);
+    shiftLeftWords(D, s);
+    Words Y = initialReciprocal(D, W, length);
+    Words scale = resizedWords(Words{1}, length);
+    shiftLeftWords(scale, 2 * W);
+
+    size_t iterations = 0;
+    for (size_t bits = 7; bits < W + 2; bits *= 2) {
+        Words error = scale;
+        subtractWords(error, multiplyWords(D, Y, length)); // 2^(2W) - D' Y, possibly negative
+        bool negative = isNegativeWords(error);
+        if (negative) negateWords(error);
+        Words step = multiplyWords(Y, error, length);
+        shiftRightWords(step, 2 * W);
+        if (negative) {
+            subtractWords(Y, step);
+        } else {
+            addWords(Y, step);
+        }
+        iterations++;
+    }
+
+    Words q = multiplyWords(resizedWords(n, length), Y, length);
+    shiftRightWords(q, 2 * W - s);
+    Words r;
+    iterations += correctQuotient(n, d, q, r);
+    n = resizedWords(q, n.size());
+    d = resizedWords(r, n.size());
+    return iterations;
+}
+
+// Goldschmidt: scale N and D' by the same factors F = 2 - D until D reaches 1; N converges to
+// the quotient. Fixed point with G = W + 16 fraction bits, the first factor from the table seed
+inline size_t goldschmidtDivide(Words& n, Words& d, size_t width) {
+    size_t W = std::max<size_t>(width, 16), G = W + 16;
+    size_t s = W - bitLengthWords(d);
+    size_t length = (2 * (W + G) + 8) / 64 + 2;
+
+    // D' / 2^W in [1/2, 1) and N 2^s / 2^W, both at G fraction bits
+    Words D = resizedWords(d, length), N = resizedWords(n, length);
+    shiftLeftWords(D, s + G - W);
+    shiftLeftWords(N, s + G - W);
+    Words two = resizedWords(Words{2}, length);
+    shiftLeftWords(two, G);
+
+    Words normalized = resizedWords(d, length);
+    shiftLeftWords(normalized, s);
+    Words F = initialReciprocal(normalized, W, length); // ~2^(2W) / D' = 2^W / (D' / 2^W)
+    shiftLeftWords(F, G);
+    shiftRightWords(F, W); // ~1 / (D' / 2^W) at G fraction bits
+
+    size_t iterations = 0;
+    for (size_t bits = 7;; bits *= 2) {
+        N = multiplyWords(N, F, length);
+        shiftRightWords(N, G);
+        D = multiplyWords(D, F, length);
+        shiftRightWords(D, G);
+        iterations++;
+        if (bits >= W + 2) break;
+        F = two;
+        subtractWords(F, D); // F = 2 - D
+    }
+
+    Words q = N;
+    shiftRightWords(q, G);
+    Words r;
+    iterations += correctQuotient(n, d, q, r);
+    n = resizedWords(q, n.size());
+    d = resizedWords(r, n.size());
+    return iterations;
+}
+
+// Run one mode on magnitudes (d != 0)
+inline size_t divideMagnitudes(Words& n, Words& d, size_t width, DivisionMode mode) {
+    switch (mode) {
+    case RestoringMode: return restoringDivide(n, d, width);
+    case NonRestoringMode: return nonRestoringDivide(n, d, width);
+    case SRTRadix4Mode: return srtRadix4Divide(n, d, width);
+    case NewtonRaphsonMode: return newtonRaphsonDivide(n, d, width);
+    case GoldschmidtMode: return goldschmidtDivide(n, d, width);
+    }
+    return 0;
+}
+
+//// Single-Word Division ////
+
+// Restoring and non-restoring division on plain 64-bit registers for widths up to 64 (so
+// magnitudes up to 2^63), the fast path for batches of small operands. Same contract as the modes
+// above; the other modes go through the word-vector implementations
+
+inline size_t restoringDivideWord(uint64_t& n, uint64_t& d, size_t width) {
+    uint64_t A = 0, Q = 0; // A < d <= 2^63, so the shifted A still fits
+    for (size_t i = width; i-- > 0;) {
+        A = (A << 1) | ((n >> i) & 1);
+        bool fits = A >= d;
+        A -= fits ? d : 0;
+        Q |= (uint64_t)fits << i;
+    }
+    n = Q;
+    d = A;
+    return width;
+}
+
+inline size_t nonRestoringDivideWord(uint64_t& n, uint64_t& d, size_t width) {
+    __int128 A = 0; // -d <= A < d needs one bit more than a word
+    uint64_t Q = 0;
+    for (size_t i = width; i-- > 0;) {
+        A = 2 * A + ((n >> i) & 1);
+        A += A < 0 ? (__int128)d : -(__int128)d;
+        Q |= (uint64_t)(A >= 0) << i;
+    }
+    if (A < 0) A += d;
+    n = Q;
+    d = (uint64_t)A;
+    return width + 1;
+}
+
+inline size_t divideWordMagnitudes(uint64_t& n, uint64_t& d, size_t width, DivisionMode mode) {
+    if (mode == RestoringMode) return restoringDivideWord(n, d, width);
+    if (mode == NonRestoringMode) return nonRestoringDivideWord(n, d, width);
+    Words N = {n, 0}, D = {d, 0};
+    size_t iterations = divideMagnitudes(N, D, width, mode);
+    n = N[0];
+    d = D[0];
+    return iterations;
+}
+
+//// Division API ////
+
+// Load a width-bit Two's Complement binary (MSB first) as a magnitude; returns the sign
+inline bool loadDivisionOperand(const std::vector<bool>& binary, Words& magnitude) {
+    size_t width = binary.size();
+    magnitude.assign((width + 63) / 64 + 1, 0);
+    for (size_t j = 0; j < width; j++) {
+        if (binary[width - 1 - j]) setBit(magnitude, j);
+    }
+    bool isNegative = width > 0 && binary[0];
+    if (isNegative) {
+        negateWords(magnitude);
+        maskWords(magnitude, width);
+    }
+    return isNegative;
+}
+
+inline std::vector<bool> storeDivisionResult(Words value, bool isNegative, size_t width) {
+    if (isNegative) negateWords(value);
+    std::vector<bool> binary(width);
+    for (size_t j = 0; j < width; j++) binary[width - 1 - j] = bitAt(value, j);
+    return binary;
+}
+
+// Divide two width-bit Two's Complement operands (the wider one sets the width)
+inline DivisionResult divide(const std::vector<bool>& dividend, const std::vector<bool>& divisor, DivisionMode mode) {
+    size_t width = std::max(dividend.size(), divisor.size());
+    auto extend = [width](const std::vector<bool>& binary) {
+        std::vector<bool> extended(width - binary.size(), !binary.empty() && binary[0]);
+        extended.insert(extended.end(), binary.begin(), binary.end());
+        return extended;
+    };
+    Words n, d;
+    bool dividendNegative = loadDivisionOperand(extend(dividend), n);
+    bool divisorNegative = loadDivisionOperand(extend(divisor), d);
+
+    DivisionResult result;
+    if (isZeroWords(d)) {
+        result.divisionByZero = true;
+        result.quotient.assign(width, 0);
+        result.remainder.assign(width, 0);
+        return result;
+    }
+    result.iterations = divideMagnitudes(n, d, width, mode);
+    result.quotient = storeDivisionResult(n, dividendNegative != divisorNegative, width);
+    result.remainder = storeDivisionResult(d, dividendNegative, width);
+    return result;
+}
+
+inline std::vector<bool> divisionOperand(int64_t value, size_t width) {
+    std::vector<bool> binary(width);
+    for (size_t j = 0; j < width; j++) binary[width - 1 - j] = (value >> std::min<size_t>(j, 63)) & 1;
+    return binary;
+}
+
+inline DivisionResult divide(int64_t dividend, int64_t divisor, size_t width, DivisionMode mode) {
+    return divide(divisionOperand(dividend, width), divisionOperand(divisor, width), mode);
+}
+
+//// Prepared Divisors ////
+
+// Division by a divisor known in advance (Granlund-Montgomery): with l = ceil(log2 d) and
+// m = ceil(2^(N + l) / d), floor(n / d) = floor(n * m / 2^(N + l)) for every n below 2^N, so once m
+// is computed each divide is a multiply and a shift, plus a multiply-subtract for the remainder
+
+struct PreparedDivisor {
+    Words divisor;               // |divisor|, (width + 63) / 64 + 1 words
+    bool isNegative = false;
+    size_t width = 0;            // Operand width in bits (N)
+    size_t shift = 0;            // l = ceil(log2 |divisor|)
+    Words magic;                 // ceil(2^(N + l) / |divisor|), at most N + 1 bits
+    uint64_t magic64 = 0;        // For width <= 64: m - 2^64 with N = 64, the 64-bit multiplier
+    bool divisionByZero = false;
+};
+
+inline PreparedDivisor prepareDivisor(const std::vector<bool>& divisor) {
+    PreparedDivisor prepared;
+    prepared.width = divisor.size();
+    prepared.isNegative = loadDivisionOperand(divisor, prepared.divisor);
+    if (isZeroWords(prepared.divisor)) {
+        prepared.divisionByZero = true;
+        return prepared;
+    }
+    Words below = prepared.divisor;
+    below[0]--;
+    for (size_t i = 0; below[i] == ~(uint64_t)0 && i + 1 < below.size(); i++) below[i + 1]--;
+    prepared.shift = bitLengthWords(below);
+
+    // m = ceil(2^(N + l) / d), using the engine itself for the one real division
+    size_t magicWidth = prepared.width + prepared.shift + 1;
+    size_t length = (magicWidth + 63) / 64 + 1;
+    Words n(length, 0), d = resizedWords(prepared.divisor, length);
+    setBit(n, prepared.width + prepared.shift);
+    divideMagnitudes(n, d, magicWidth, NewtonRaphsonMode);
+    if (!isZeroWords(d)) addSmallWords(n, 1);
+    prepared.magic = n;
+
+    // Single-word magic for N = 64 (|divisor| <= 2^63, so l <= 63): floor(2^64 (2^l - d) / d) + 1
+    if (prepared.width <= 64) {
+        uint64_t d64 = prepared.divisor[0];
+        unsigned __int128 numerator = (unsigned __int128)(((uint64_t)1 << prepared.shift) - d64) << 64;
+        prepared.magic64 = (uint64_t)(numerator / d64) + 1;
+    }
+    return prepared;
+}
+
+inline PreparedDivisor prepareDivisor(int64_t divisor, size_t width) {
+    return prepareDivisor(divisionOperand(divisor, width));
+}
+
+// Quotient of a magnitude below 2^64 (width <= 64)
+inline uint64_t dividePreparedWord(uint64_t n, const PreparedDivisor& divisor) {
+    uint64_t high = (uint64_t)(((unsigned __int128)divisor.magic64 * n) >> 64);
+    size_t l = divisor.shift;
+    return (high + ((n - high) >> std::min<size_t>(l, 1))) >> (l ? l - 1 : 0);
+}
+
+// n / |divisor| on magnitudes below 2^width: the quotient replaces n, the remainder is returned
+inline Words dividePreparedMagnitude(Words& n, const PreparedDivisor& divisor) {
+    size_t length = n.size();
+    Words product = multiplyWords(n, divisor.magic, (2 * divisor.width + divisor.shift + 1 + 63) / 64 + 1);
+    shiftRightWords(product, divisor.width + divisor.shift);
+    Words quotient = resizedWords(product, length);
+    Words remainder = n;
+    subtractWords(remainder, multiplyWords(quotient, resizedWords(divisor.divisor, length), length));
+    n = quotient;
+    return remainder;
+}
+
+// Divide a Two's Complement dividend (MSB first) by a prepared divisor; a dividend wider than the
+// prepared width falls back to Newton-Raphson
+inline DivisionResult divide(const std::vector<bool>& dividend, const PreparedDivisor& divisor) {
+    size_t width = divisor.width;
+    if (dividend.size() > width) {
+        return divide(dividend, storeDivisionResult(divisor.divisor, divisor.isNegative, width), NewtonRaphsonMode);
+    }
+    DivisionResult result;
+    if (divisor.divisionByZero) {
+        result.divisionByZero = true;
+        result.quotient.assign(width, 0);
+        result.remainder.assign(width, 0);
+        return result;
+    }
+    std::vector<bool> extended(width - dividend.size(), !dividend.empty() && dividend[0]);
+    extended.insert(extended.end(), dividend.begin(), dividend.end());
+    Words n;
+    bool dividendNegative = loadDivisionOperand(extended, n);
+    Words remainder = dividePreparedMagnitude(n, divisor);
+    result.iterations = 1;
+    result.quotient = storeDivisionResult(n, dividendNegative != divisor.isNegative, width);
+    result.remainder = storeDivisionResult(remainder, dividendNegative, width);
+    return result;
+}
+
+// Divide count width-bit dividends (width <= 64) by one prepared divisor. Results wrap to width
+// bits and are sign-extended, as divide() does; a zero divisor or a wider width leaves zeros and
+// returns false
+inline bool divideBatch(const PreparedDivisor& divisor, const int64_t* dividends, size_t count,
+                        int64_t* quotients, int64_t* remainders) {
+    if (divisor.divisionByZero || divisor.width > 64) {
+        std::fill(quotients, quotients + count, 0);
+        std::fill(remainders, remainders + count, 0);
+        return false;
+    }
+    size_t extend = 64 - divisor.width;
+    uint64_t d = divisor.divisor[0];
+    for (size_t k = 0; k < count; k++) {
+        int64_t value = (int64_t)((uint64_t)dividends[k] << extend) >> extend;
+        uint64_t n = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+        uint64_t q = dividePreparedWord(n, divisor);
+        uint64_t r = n - q * d;
+        if ((value < 0) != divisor.isNegative) q = 0 - q;
+        if (value < 0) r = 0 - r;
+        quotients[k] = (int64_t)q;
+        remainders[k] = (int64_t)r;
+    }
+    signExtendBatch((uint64_t*)quotients, count, divisor.width);
+    signExtendBatch((uint64_t*)remainders, count, divisor.width);
+    return true;
+}
+
+// Bounded LRU cache of prepared divisors keyed by value and width. References returned by get()
+// stay valid until that entry is evicted
+class PreparedDivisorCache {
+private:
+    typedef std::vector<bool> Key; // The divisor's Two's Complement bits; the width is its size
+    std::list<std::pair<Key, PreparedDivisor>> entries; // Most recently used first
+    std::map<Key, std::list<std::pair<Key, PreparedDivisor>>::iterator> index;
+    size_t capacity;
+
+public:
+    size_t hits = 0, misses = 0, evictions = 0;
+
+    explicit PreparedDivisorCache(size_t capacity = 64) : capacity(std::max<size_t>(capacity, 1)) {}
+
+    const PreparedDivisor& get(const std::vector<bool>& divisor) {
+        auto found = index.find(divisor);
+        if (found != index.end()) {
+            hits++;
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->second;
+        }
+        misses++;
+        if (entries.size() == capacity) {
+            evictions++;
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(divisor, prepareDivisor(divisor));
+        index[divisor] = entries.begin();
+        return entries.front().second;
+    }
+
+    const PreparedDivisor& get(int64_t divisor, size_t width) { return get(divisionOperand(divisor, width)); }
+
+    size_t size() const { return entries.size(); }
+};
+
+//// Division Trace ////
+
+// The classic bit-serial divisions record their steps as compact binary events through a buffered
+// sink instead of formatting text; replayDivisionTrace turns a recorded trace back into the classic
+// step-by-step listing. The trace level is a template argument of the algorithm, so TraceOff
+// compiles the recording out entirely and TraceSummary keeps only the first and last events.
+//
+// Trace format: a sequence of events, each one tag byte followed by its fields. Integers are
+// little-endian; a register is its bit count (4 bytes) then its bits MSB first, 8 per byte
+//   TraceBegin:      algorithm (1 byte), bit width (4 bytes), dividend (8 bytes), divisor (8 bytes)
+//   TraceInitial:    A, Q, M
+//   TraceShift:      A, Q          (after the left shift of A:Q)
+//   TraceSubtract:   A             (after A - M)
+//   TraceAdd:        A             (after A + M)
+//   TraceRestore:    -             (A was negative and is restored)
+//   TraceUpdate:     A, Q          (end of an iteration)
+//   TraceCorrection: A             (final remainder correction)
+//   TraceEnd:        remainder, quotient
+
+enum TraceLevel { TraceOff, TraceSummary, TraceFull };
+
+// Passes a trace level to a generic callable, which instantiates the traced division at it:
+//   [](auto level, int dividend, int divisor, int bitWidth, DivisionTraceSink* sink) {
+//       return restoringDivision<decltype(level)::value>(dividend, divisor, bitWidth, sink); }
+template <TraceLevel Level>
+using TraceLevelTag = std::integral_constant<TraceLevel, Level>;
+
+enum DivisionTraceEvent : uint8_t {
+    TraceBegin, TraceInitial, TraceShift, TraceSubtract, TraceAdd, TraceRestore, TraceUpdate, TraceCorrection, TraceEnd
+};
+
+enum TracedAlgorithm : uint8_t { TracedRestoring, TracedNonRestoring };
+
+// Buffers encoded events and writes them to the stream in large blocks
+class DivisionTraceSink {
+private:
+    std::ostream& out;
+    std::vector<uint8_t> buffer;
+    size_t used = 0;
+
+    void reserve(size_t bytes) {
+        if (used + bytes > buffer.size()) flush();
+        if (bytes > buffer.size()) buffer.resize(bytes);
+    }
+
+public:
+    explicit DivisionTraceSink(std::ostream& out, size_t capacity = 1 << 16)
+        : out(out), buffer(std::max<size_t>(capacity, 64)) {}
+    ~DivisionTraceSink() { flush(); }
+
+    void putByte(uint8_t byte) {
+        reserve(1);
+        buffer[used++] = byte;
+    }
+
+    void putInteger(uint64_t value, size_t bytes) {
+        reserve(bytes);
+        for (size_t i = 0; i < bytes; i++) buffer[used++] = (uint8_t)(value >> (8 * i));
+    }
+
+    void putRegister(const std::vector<bool>& bits) {
+        putInteger(bits.size(), 4);
+        reserve((bits.size() + 7) / 8);
+        for (size_t i = 0; i < bits.size(); i += 8) {
+            uint8_t byte = 0;
+            for (size_t j = 0; j < 8; j++) byte |= (uint8_t)((i + j < bits.size() && bits[i + j]) << (7 - j));
+            buffer[used++] = byte;
+        }
+    }
+
+    void putRegister(const PackedRegister& reg) {
+        putInteger(reg.width, 4);
+        reserve((reg.width + 7) / 8);
+        for (size_t i = 0; i < reg.width; i += 8) {
+            uint8_t byte = 0;
+            for (size_t j = 0; j < 8; j++) byte |= (uint8_t)((i + j < reg.width && reg.bit(reg.width - 1 - i - j)) << (7 - j));
+            buffer[used++] = byte;
+        }
+    }
+
+    void flush() {
+        out.write((const char*)buffer.data(), used);
+        used = 0;
+    }
+
+    // Event encoders
+    void begin(TracedAlgorithm algorithm, size_t bitWidth, int64_t dividend, int64_t divisor) {
+        putByte(TraceBegin);
+        putByte(algorithm);
+        putInteger(bitWidth, 4);
+        putInteger((uint64_t)dividend, 8);
+        putInteger((uint64_t)divisor, 8);
+    }
+
+    template <typename... Registers>
+    void event(DivisionTraceEvent tag, const Registers&... registers) {
+        putByte(tag);
+        (putRegister(registers), ...);
+    }
+};
+
+inline bool readTraceInteger(std::istream& in, uint64_t& value, size_t bytes) {
+    value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+        value |= (uint64_t)byte << (8 * i);
+    }
+    return true;
+}
+
+inline bool readTraceRegister(std::istream& in, std::vector<bool>& bits) {
+    uint64_t size;
+    if (!readTraceInteger(in, size, 4)) return false;
+    bits.assign(size, 0);
+    for (size_t i = 0; i < size; i += 8) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+        for (size_t j = 0; j < 8 && i + j < size; j++) bits[i + j] = (byte >> (7 - j)) & 1;
+    }
+    return true;
+}
+
+// Pretty-print a recorded trace in the classic format; returns false on a truncated or unknown
+// event (everything before it is still printed)
+inline bool replayDivisionTrace(std::istream& in, std::ostream& out = std::cout) {
+    auto print = [&out](const char* name, const std::vector<bool>& bits) {
+        out << name << ": ";
+        for (bool bit : bits) out << bit;
+        out << "\n";
+    };
+    std::vector<bool> A, Q, M;
+    int tag;
+    while ((tag = in.get()) != EOF) {
+        switch (tag) {
+        case TraceBegin: {
+            uint64_t algorithm, bitWidth, dividend, divisor;
+            if (!readTraceInteger(in, algorithm, 1) || !readTraceInteger(in, bitWidth, 4) ||
+                !readTraceInteger(in, dividend, 8) || !readTraceInteger(in, divisor, 8)) return false;
+            out << (algorithm == TracedRestoring ? "Restoring" : "Non-Restoring") << " Division: "
+                << (int64_t)dividend << " / " << (int64_t)divisor << " (" << bitWidth << " bits)\n";
+            break;
+        }
+        case TraceInitial:
+            if (!readTraceRegister(in, A) || !readTraceRegister(in, Q) || !readTraceRegister(in, M)) return false;
+            out << "Initial Values:\n";
+            print("A", A);
+            print("Q", Q);
+            print("M", M);
+            out << "--------------------\n";
+            break;
+        case TraceShift:
+            if (!readTraceRegister(in, A) || !readTraceRegister(in, Q)) return false;
+            out << "After Left Shift:\n";
+            print("A", A);
+            print("Q", Q);
+            break;
+        case TraceSubtract:
+        case TraceAdd:
+            if (!readTraceRegister(in, A)) return false;
+            out << (tag == TraceSubtract ? "After Subtraction (A - M):\n" : "After Addition (A + M):\n");
+            print("A", A);
+            break;
+        case TraceRestore:
+            out << "A is Negative: Restoring A.\n";
+            break;
+        case TraceUpdate:
+            if (!readTraceRegister(in, A) || !readTraceRegister(in, Q)) return false;
+            out << "Updated State:\n";
+            print("A", A);
+            print("Q", Q);
+            out << "--------------------\n";
+            break;
+        case TraceCorrection:
+            if (!readTraceRegister(in, A)) return false;
+            out << "Final Correction (A + M):\n";
+            print("A", A);
+            break;
+        case TraceEnd:
+            if (!readTraceRegister(in, A) || !readTraceRegister(in, Q)) return false;
+            print("Remainder", A);
+            print("Quotient", Q);
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+//// Division Benchmark ////
+
+// Iterations and wall time per divide for every mode on random width-bit operands (divisors
+// of random length, so normalization shifts vary), with each quotient checked against restoring
+inline void runDivisionBenchmark(size_t samples = 2000, uint64_t seed = 1, std::ostream& out = std::cout) {
+    const DivisionMode modes[] = {RestoringMode, NonRestoringMode, SRTRadix4Mode, NewtonRaphsonMode, GoldschmidtMode};
+    std::mt19937_64 generator(seed);
+    out << "Width | Mode | Iterations/divide | us/divide\n";
+    for (size_t width = 8; width <= 1024; width *= 2) {
+        std::vector<Words> dividends(samples), divisors(samples);
+        size_t words = (width + 63) / 64 + 1;
+        for (size_t k = 0; k < samples; k++) {
+            dividends[k].assign(words, 0);
+            divisors[k].assign(words, 0);
+            size_t divisorBits = 1 + generator() % width;
+            for (size_t j = 0; j < width; j++) {
+                if (generator() & 1) setBit(dividends[k], j);
+                if (j < divisorBits && (generator() & 1)) setBit(divisors[k], j);
+            }
+            if (isZeroWords(divisors[k])) divisors[k][0] = 1;
+        }
+
+        std::vector<Words> expected(samples);
+        for (DivisionMode mode : modes) {
+            size_t iterations = 0, mismatches = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < samples; k++) {
+                Words n = dividends[k], d = divisors[k];
+                iterations += divideMagnitudes(n, d, width, mode);
+                if (mode == RestoringMode) {
+                    expected[k] = n;
+                } else if (n != expected[k]) {
+                    mismatches++;
+                }
+            }
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / samples;
+            out << width << " | " << divisionModeName(mode) << " | " << (double)iterations / samples << " | " << us
+                << (mismatches ? " (MISMATCH)" : "") << "\n";
+        }
+    }
+}
+
+// Batch division by a few fixed divisors through the prepared-divisor cache, against per-element
+// restoring division; every quotient and remainder is checked against both restoring and
+// non-restoring
+inline void runPreparedDivisionBenchmark(size_t samples = 20000, uint64_t seed = 1, std::ostream& out = std::cout) {
+    std::mt19937_64 generator(seed);
+    PreparedDivisorCache cache(16);
+    out << "Width | Divisors | Restoring us/divide | Prepared us/divide | Mismatches\n";
+    for (size_t width = 8; width <= 1024; width *= 2) {
+        auto randomOperand = [&](size_t bits) {
+            std::vector<bool> binary(width, 0);
+            for (size_t j = 0; j < bits; j++) binary[width - 1 - j] = generator() & 1;
+            return binary;
+        };
+        std::vector<std::vector<bool>> divisors(8), dividends(samples);
+        for (auto& divisor : divisors) {
+            do {
+                divisor = randomOperand(1 + generator() % width);
+            } while (std::find(divisor.begin(), divisor.end(), true) == divisor.end());
+        }
+        for (auto& dividend : dividends) dividend = randomOperand(width);
+
+        std::vector<DivisionResult> expected(samples);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t k = 0; k < samples; k++) expected[k] = divide(dividends[k], divisors[k % divisors.size()], RestoringMode);
+        double restoringUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / samples;
+
+        // Width <= 64 takes the single-word batch path, wider operands the word-vector path
+        std::vector<DivisionResult> actual(samples);
+        std::vector<int64_t> values(samples), quotients(samples), remainders(samples);
+        auto toInteger = [](const std::vector<bool>& binary) {
+            int64_t value = binary[0] ? -1 : 0;
+            for (bool bit : binary) value = (int64_t)((uint64_t)value << 1) | bit;
+            return value;
+        };
+        for (size_t k = 0; k < samples && width <= 64; k++) values[k] = toInteger(dividends[k]);
+        start = std::chrono::steady_clock::now();
+        for (size_t group = 0; group < divisors.size(); group++) {
+            const PreparedDivisor& prepared = cache.get(divisors[group]);
+            if (width <= 64) {
+                // Dividends are strided by divisor; gather them into one contiguous batch
+                std::vector<int64_t> batch, batchQuotients, batchRemainders;
+                for (size_t k = group; k < samples; k += divisors.size()) batch.push_back(values[k]);
+                batchQuotients.resize(batch.size());
+                batchRemainders.resize(batch.size());
+                divideBatch(prepared, batch.data(), batch.size(), batchQuotients.data(), batchRemainders.data());
+                for (size_t k = group, i = 0; k < samples; k += divisors.size(), i++) {
+                    quotients[k] = batchQuotients[i];
+                    remainders[k] = batchRemainders[i];
+                }
+            } else {
+                for (size_t k = group; k < samples; k += divisors.size()) actual[k] = divide(dividends[k], prepared);
+            }
+        }
+        double preparedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / samples;
+
+        size_t mismatches = 0;
+        for (size_t k = 0; k < samples; k++) {
+            DivisionResult check = divide(dividends[k], divisors[k % divisors.size()], NonRestoringMode);
+            if (width <= 64) {
+                actual[k].quotient = divisionOperand(quotients[k], width);
+                actual[k].remainder = divisionOperand(remainders[k], width);
+            }
+            bool matches = actual[k].quotient == expected[k].quotient && actual[k].remainder == expected[k].remainder &&
+                           check.quotient == expected[k].quotient && check.remainder == expected[k].remainder;
+            mismatches += !matches;
+        }
+        out << width << " | " << divisors.size() << " | " << restoringUs << " | " << preparedUs << " | " << mismatches << "\n";
+    }
+    out << "Cache: " << cache.hits << " hits, " << cache.misses << " misses, " << cache.evictions << " evictions\n";
+}
+
+// Time the same divisions at each trace level (TraceFull into memory, then with the text replay
+// that used to run inline) to show what the trace costs. tracedDivide(TraceLevelTag, dividend,
+// divisor, bitWidth, sink) runs one bit-serial division and returns its (remainder, quotient)
+template <typename TracedDivide>
+inline void runTraceLevelBenchmark(TracedDivide tracedDivide, int bitWidth = 24, int samples = 2000,
+                                   std::ostream& out = std::cout) {
+    std::vector<std::pair<int, int>> operands(samples);
+    unsigned state = 12345;
+    for (auto& [dividend, divisor] : operands) {
+        state = state * 1103515245 + 12345;
+        dividend = (int)(state >> 9) - (1 << 22);
+        state = state * 1103515245 + 12345;
+        divisor = (int)(state >> 20) - 2048;
+        if (divisor == 0) divisor = 1;
+    }
+    auto time = [&](auto&& run) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / samples;
+    };
+    auto runLevel = [&](auto level, DivisionTraceSink* sink) {
+        size_t checksum = 0;
+        for (auto [dividend, divisor] : operands) checksum += tracedDivide(level, dividend, divisor, bitWidth, sink).second[bitWidth - 1];
+        return checksum;
+    };
+    size_t checksum = 0;
+    std::ostringstream summaryBytes, fullBytes, text;
+    double off = time([&] { checksum += runLevel(TraceLevelTag<TraceOff>(), nullptr); });
+    double summary = time([&] {
+        DivisionTraceSink sink(summaryBytes);
+        checksum += runLevel(TraceLevelTag<TraceSummary>(), &sink);
+    });
+    double full = time([&] {
+        DivisionTraceSink sink(fullBytes);
+        checksum += runLevel(TraceLevelTag<TraceFull>(), &sink);
+    });
+    std::istringstream recorded(fullBytes.str());
+    double replay = time([&] { replayDivisionTrace(recorded, text); });
+
+    out << "Trace Level | us/divide | Trace bytes/divide\n";
+    out << "Off | " << off << " | 0\n";
+    out << "Summary | " << summary << " | " << (double)summaryBytes.str().size() / samples << "\n";
+    out << "Full | " << full << " | " << (double)fullBytes.str().size() / samples << "\n";
+    out << "Full + text replay | " << full + replay << " | " << (double)text.str().size() / samples << " (text)\n";
+    out << "(checksum " << checksum << ")\n";
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//// Mapped Input Files ////
+
+// Read-only memory map of an input file (falls back to reading it when it cannot be mapped)
+class MappedFile {
+private:
+    void* mapping = MAP_FAILED;
+    std::string fallback;
+
+public:
+    const char* data = nullptr;
+    size_t size = 0;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) return false;
+        struct stat info;
+        if (fstat(descriptor, &info) == 0 && info.st_size > 0) {
+            size = info.st_size;
+            mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        }
+        ::close(descriptor);
+
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+        } else {
+            std::ifstream file(path, std::ios::binary);
+            fallback.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data = fallback.data();
+            size = fallback.size();
+        }
+        return true;
+    }
+
+    ~MappedFile() {
+        if (mapping != MAP_FAILED) munmap(mapping, size);
+    }
+};
+
+#endif
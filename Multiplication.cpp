@@ -1,112 +1,887 @@
 #include <iostream>
 #include <vector>
-#include <algorithm> // For reverse function
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <random>
+#include <thread>
+#include "DifferentialVerifier.h"
+#include "PackedRegister.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h> // AVX2 / AVX-512 batch multiply
+#endif
 
 using namespace std;
 
-//// Helper Functions ////
+//// Allocation Counter ////
+
+// Built with -DCOUNT_ALLOCATIONS, global operator new is replaced so the benchmark can report heap
+// allocations per multiply; other builds keep the default allocator and pay nothing
+#ifdef COUNT_ALLOCATIONS
+atomic<uint64_t> heapAllocations(0);
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    if (void* block = malloc(size ? size : 1)) return block;
+    throw bad_alloc();
+}
+// GCC pairs the inlined free() with the new-expression and warns; the two do match through malloc
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { free(block); }
+#pragma GCC diagnostic pop
+#endif
 
-// Convert an integer to binary
-vector<bool> integerToBinary(int number) {
-    vector<bool> binary;
-    bool isNegative = (number < 0); // Check if the number is negative
-    number = abs(number); // Work with the absolute value
+//// Multiplication Function ////
 
-    while (number > 0) {
-        binary.push_back(number % 2); // Extract least significant bit
-        number /= 2;
+// Register-level shift-and-add, kept as the reference the packed engine is verified against
+vector<bool> shiftAndAddMultiplication(int multiplicand, int multiplier) {
+    bool isNegativeResult = (multiplicand < 0) ^ (multiplier < 0); // XOR to determine result sign
+    int64_t magnitudeMultiplicand = llabs((int64_t)multiplicand), magnitudeMultiplier = llabs((int64_t)multiplier);
+    vector<bool> binaryMultiplicand = integerToBinary(magnitudeMultiplicand);
+    vector<bool> binaryMultiplier = integerToBinary(magnitudeMultiplier);
+    size_t size = binaryMultiplicand.size() + binaryMultiplier.size() + 1; // Magnitude bits plus a sign bit
+    PackedRegister product(size); // Initialize product with zeros
+    PackedRegister shiftedMultiplicand = packInteger(magnitudeMultiplicand, size);
+
+    // Binary multiplication (shift-and-add method), one word-wide add per set multiplier bit
+    for (size_t i = binaryMultiplier.size(); i-- > 0;) {
+        if (binaryMultiplier[i]) addPacked(product, shiftedMultiplicand);
+        shiftLeftPacked(shiftedMultiplicand, 1); // Left shift multiplicand
     }
-    reverse(binary.begin(), binary.end()); // Reverse to get MSB first
 
-    if (isNegative) {
-        // Two's complement for negative numbers
-        for (size_t i = 0; i < binary.size(); i++) {
-            binary[i] = !binary[i]; // Flip bits
-        }
+    // Convert result to two's complement for negative numbers
+    if (isNegativeResult) negatePacked(product);
 
-        // Add 1 to complete two's complement
-        bool carry = 1;
-        for (size_t i = binary.size(); i-- > 0;) {
-            binary[i] = binary[i] ^ carry;
-            carry = binary[i] & carry;
+    return unpackBinary(product);
+}
+
+//// Multiplication Tiers ////
+
+// Magnitudes are arrays of 64-bit limbs, least significant limb first. multiplyMagnitudes picks
+// schoolbook, Karatsuba, Toom-3 or an NTT by the size of the shorter operand; the crossovers
+// (in limbs) are measured by tuneMultiplicationCrossovers at startup
+struct MultiplicationCrossovers {
+    size_t karatsuba = 32;
+    size_t toom3 = 256;
+    size_t ntt = 4096;
+};
+
+MultiplicationCrossovers crossovers;
+
+void multiplyMagnitudes(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out);
+
+// x += y (xn >= yn), returns the carry out of x
+uint64_t addLimbs(uint64_t* x, size_t xn, const uint64_t* y, size_t yn) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < xn && (i < yn || carry); i++) {
+        unsigned __int128 t = (unsigned __int128)x[i] + (i < yn ? y[i] : 0) + carry;
+        x[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    return carry;
+}
+
+// x -= y (xn >= yn), returns the borrow out of x
+uint64_t subLimbs(uint64_t* x, size_t xn, const uint64_t* y, size_t yn) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < xn && (i < yn || borrow); i++) {
+        uint64_t yi = i < yn ? y[i] : 0;
+        uint64_t diff = x[i] - yi - borrow;
+        borrow = (x[i] < yi) || (x[i] - yi < borrow);
+        x[i] = diff;
+    }
+    return borrow;
+}
+
+size_t usedLimbs(const uint64_t* x, size_t n) {
+    while (n > 0 && x[n - 1] == 0) n--;
+    return n;
+}
+
+// Schoolbook multiply of an-limb a by bn-limb b into the an + bn limbs at out
+void schoolbookMultiply(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
+    fill(out, out + an + bn, 0);
+    for (size_t i = 0; i < an; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < bn; j++) {
+            unsigned __int128 t = (unsigned __int128)a[i] * b[j] + out[i + j] + carry;
+            out[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
         }
+        out[i + bn] = carry;
+    }
+}
 
-        if (carry) binary.insert(binary.begin(), 1); // Overflow bit for carry
+// Karatsuba (an >= bn): split at h limbs, three half-size products
+//   z0 = a0 * b0, z2 = a1 * b1, z1 = (a0 + a1)(b0 + b1) - z0 - z2
+void karatsubaMultiply(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
+    size_t h = (an + 1) / 2;
+    size_t a1n = an - h, b1n = bn > h ? bn - h : 0, b0n = bn - b1n;
+    fill(out, out + an + bn, 0);
+    multiplyMagnitudes(a, h, b, b0n, out);                // z0 in out[0, h + b0n)
+    multiplyMagnitudes(a + h, a1n, b + h, b1n, out + 2 * h); // z2 in out[2h, an + bn)
+
+    vector<uint64_t> sumA(h + 1, 0), sumB(h + 1, 0), z1(2 * h + 2);
+    copy(a, a + h, sumA.begin());
+    sumA[h] = addLimbs(sumA.data(), h, a + h, a1n);
+    copy(b, b + b0n, sumB.begin());
+    sumB[h] = addLimbs(sumB.data(), h, b + h, b1n);
+    multiplyMagnitudes(sumA.data(), h + 1, sumB.data(), h + 1, z1.data());
+    subLimbs(z1.data(), z1.size(), out, h + b0n);
+    subLimbs(z1.data(), z1.size(), out + 2 * h, a1n + b1n);
+    addLimbs(out + h, an + bn - h, z1.data(), usedLimbs(z1.data(), z1.size()));
+}
+
+// Fixed-length Two's Complement helpers for the signed intermediate values of Toom-3
+typedef vector<uint64_t> SignedLimbs;
+
+SignedLimbs toSigned(const uint64_t* x, size_t n, size_t length) {
+    SignedLimbs value(length, 0);
+    copy(x, x + min(n, length), value.begin());
+    return value;
+}
+
+bool isNegativeSigned(const SignedLimbs& x) { return x.back() >> 63; }
+
+void negateSigned(SignedLimbs& x) {
+    uint64_t carry = 1;
+    for (uint64_t& limb : x) {
+        limb = ~limb + carry;
+        carry = carry && limb == 0;
     }
-    return binary;
 }
 
-// Convert binary to integer
-int binaryToInteger(const vector<bool>& binary) {
-    bool isNegative = binary[0]; // Check the sign bit
-    vector<bool> absBinary = binary;
+void addSigned(SignedLimbs& x, const SignedLimbs& y) { addLimbs(x.data(), x.size(), y.data(), y.size()); }
+void subSigned(SignedLimbs& x, const SignedLimbs& y) { subLimbs(x.data(), x.size(), y.data(), y.size()); }
 
-    if (isNegative) {
-        // Two's complement conversion for negative numbers
-        for (size_t i = 0; i < absBinary.size(); i++) {
-            absBinary[i] = !absBinary[i]; // Flip bits
+void shiftLeftSigned(SignedLimbs& x, int bits) {
+    for (size_t i = x.size(); i-- > 0;) x[i] = (x[i] << bits) | (i ? x[i - 1] >> (64 - bits) : 0);
+}
+
+// Exact division by 2 (arithmetic shift) and by 3 (long division on the magnitude)
+void halveSigned(SignedLimbs& x) {
+    uint64_t sign = isNegativeSigned(x) ? ~(uint64_t)0 : 0;
+    for (size_t i = 0; i < x.size(); i++) x[i] = (x[i] >> 1) | ((i + 1 < x.size() ? x[i + 1] : sign) << 63);
+}
+
+void divideByThreeSigned(SignedLimbs& x) {
+    bool negative = isNegativeSigned(x);
+    if (negative) negateSigned(x);
+    unsigned __int128 remainder = 0;
+    for (size_t i = x.size(); i-- > 0;) {
+        unsigned __int128 current = (remainder << 64) | x[i];
+        x[i] = (uint64_t)(current / 3);
+        remainder = current % 3;
+    }
+    if (negative) negateSigned(x);
+}
+
+SignedLimbs multiplySigned(SignedLimbs x, SignedLimbs y, size_t length) {
+    bool negative = isNegativeSigned(x) ^ isNegativeSigned(y);
+    if (isNegativeSigned(x)) negateSigned(x);
+    if (isNegativeSigned(y)) negateSigned(y);
+    size_t xn = usedLimbs(x.data(), x.size()), yn = usedLimbs(y.data(), y.size());
+    SignedLimbs product(max(length, xn + yn), 0);
+    multiplyMagnitudes(x.data(), xn, y.data(), yn, product.data());
+    product.resize(length);
+    if (negative) negateSigned(product);
+    return product;
+}
+
+// Toom-3 (an >= bn): split into three k-limb pieces, evaluate at 0, 1, -1, -2 and infinity,
+// multiply pointwise and interpolate (Bodrato's sequence)
+void toom3Multiply(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
+    size_t k = (an + 2) / 3;
+    size_t evalLength = k + 2, productLength = 2 * k + 4;
+    auto piece = [&](const uint64_t* x, size_t n, size_t i) {
+        size_t from = min(n, i * k), to = min(n, (i + 1) * k);
+        return toSigned(x + from, to - from, evalLength);
+    };
+
+    // Evaluations p(0), p(1), p(-1), p(-2), p(inf) of each operand's polynomial
+    auto evaluate = [&](const uint64_t* x, size_t n) {
+        SignedLimbs x0 = piece(x, n, 0), x1 = piece(x, n, 1), x2 = piece(x, n, 2);
+        SignedLimbs sum02 = x0;
+        addSigned(sum02, x2);
+        SignedLimbs p1 = sum02, pm1 = sum02;
+        addSigned(p1, x1);
+        subSigned(pm1, x1);
+        SignedLimbs pm2 = pm1; // (p(-1) + x2) * 2 - x0
+        addSigned(pm2, x2);
+        shiftLeftSigned(pm2, 1);
+        subSigned(pm2, x0);
+        return vector<SignedLimbs>{x0, p1, pm1, pm2, x2};
+    };
+    vector<SignedLimbs> pa = evaluate(a, an), pb = evaluate(b, bn);
+    vector<SignedLimbs> r(5);
+    for (int i = 0; i < 5; i++) r[i] = multiplySigned(pa[i], pb[i], productLength);
+
+    // Interpolation: r0 = r(0), r4 = r(inf)
+    SignedLimbs r3 = r[3];
+    subSigned(r3, r[1]);
+    divideByThreeSigned(r3); // (r(-2) - r(1)) / 3
+    SignedLimbs r1 = r[1];
+    subSigned(r1, r[2]);
+    halveSigned(r1); // (r(1) - r(-1)) / 2
+    SignedLimbs r2 = r[2];
+    subSigned(r2, r[0]); // r(-1) - r(0)
+    SignedLimbs twiceInf = r[4];
+    shiftLeftSigned(twiceInf, 1);
+    SignedLimbs t = r2;
+    subSigned(t, r3);
+    halveSigned(t);
+    addSigned(t, twiceInf);
+    r3 = t; // (r2 - r3) / 2 + 2 r(inf)
+    addSigned(r2, r1);
+    subSigned(r2, r[4]); // r2 + r1 - r4
+    subSigned(r1, r3);   // r1 - r3
+
+    // Recompose: every coefficient is non-negative here
+    fill(out, out + an + bn, 0);
+    const SignedLimbs* coefficients[] = {&r[0], &r1, &r2, &r3, &r[4]};
+    for (size_t i = 0; i < 5 && i * k < an + bn; i++) {
+        const SignedLimbs& c = *coefficients[i];
+        addLimbs(out + i * k, an + bn - i * k, c.data(), min(usedLimbs(c.data(), c.size()), an + bn - i * k));
+    }
+}
+
+// NTT over the prime 2^64 - 2^32 + 1 on 16-bit digits: the convolution terms stay below
+// 2^52, far under the prime, so a single modulus is exact for any size up to 2^32 digits
+const uint64_t NTT_PRIME = 0xFFFFFFFF00000001ULL;
+
+// Branch-free: the conditional corrections are applied through masks, since they are taken
+// about half the time and would otherwise mispredict
+uint64_t reduceModPrime(unsigned __int128 x) {
+    uint64_t lo = (uint64_t)x, hi = (uint64_t)(x >> 64);
+    uint64_t hiHi = hi >> 32, hiLo = hi & 0xFFFFFFFFULL;
+    uint64_t t0 = lo - hiHi;
+    t0 -= 0xFFFFFFFFULL & -(uint64_t)(lo < hiHi); // 2^96 = -1 (mod p)
+    uint64_t t1 = hiLo * 0xFFFFFFFFULL;            // 2^64 = 2^32 - 1 (mod p)
+    uint64_t result = t0 + t1;
+    result += 0xFFFFFFFFULL & -(uint64_t)(result < t1);
+    return result - (NTT_PRIME & -(uint64_t)(result >= NTT_PRIME));
+}
+
+uint64_t mulMod(uint64_t a, uint64_t b) { return reduceModPrime((unsigned __int128)a * b); }
+
+uint64_t addMod(uint64_t a, uint64_t b) {
+    uint64_t sum = a + b;
+    return sum - (NTT_PRIME & -(uint64_t)((sum < a) | (sum >= NTT_PRIME)));
+}
+
+uint64_t subMod(uint64_t a, uint64_t b) { return (a - b) + (NTT_PRIME & -(uint64_t)(a < b)); }
+
+uint64_t powMod(uint64_t base, uint64_t exponent) {
+    uint64_t result = 1;
+    for (; exponent; exponent >>= 1, base = mulMod(base, base)) {
+        if (exponent & 1) result = mulMod(result, base);
+    }
+    return result;
+}
+
+// Twiddle table for transforms up to size n: the twiddles of a length-L stage sit at [L/2, L),
+// table[L/2 + k] = w_L^k, with w_L an L-th root of unity (7 generates the multiplicative group)
+vector<uint64_t> nttTwiddles(size_t n, bool inverse) {
+    vector<uint64_t> table(max<size_t>(n, 2));
+    for (size_t length = 2; length <= n; length <<= 1) {
+        uint64_t root = powMod(7, (NTT_PRIME - 1) / length);
+        if (inverse) root = powMod(root, NTT_PRIME - 2);
+        size_t half = length / 2;
+        table[half] = 1;
+        for (size_t k = 1; k < half; k++) table[half + k] = mulMod(table[half + k - 1], root);
+    }
+    return table;
+}
+
+// Forward decimation-in-frequency transform (natural order in, bit-reversed out) and inverse
+// decimation-in-time (bit-reversed in, natural out), so the convolution needs no permutation.
+// Both recurse depth-first, which keeps the smaller stages inside the cache
+void nttForward(uint64_t* values, size_t n, const vector<uint64_t>& twiddles) {
+    if (n < 2) return;
+    size_t half = n / 2;
+    for (size_t k = 0; k < half; k++) {
+        uint64_t u = values[k], v = values[k + half];
+        values[k] = addMod(u, v);
+        values[k + half] = mulMod(subMod(u, v), twiddles[half + k]);
+    }
+    nttForward(values, half, twiddles);
+    nttForward(values + half, half, twiddles);
+}
+
+void nttInverse(uint64_t* values, size_t n, const vector<uint64_t>& twiddles) {
+    if (n < 2) return;
+    size_t half = n / 2;
+    nttInverse(values, half, twiddles);
+    nttInverse(values + half, half, twiddles);
+    for (size_t k = 0; k < half; k++) {
+        uint64_t u = values[k], v = mulMod(values[k + half], twiddles[half + k]);
+        values[k] = addMod(u, v);
+        values[k + half] = subMod(u, v);
+    }
+}
+
+void nttMultiply(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
+    size_t digits = 4 * (an + bn), size = 1;
+    while (size < digits) size <<= 1;
+    vector<uint64_t> fa(size, 0), fb(size, 0);
+    for (size_t i = 0; i < 4 * an; i++) fa[i] = (a[i / 4] >> (16 * (i % 4))) & 0xFFFF;
+    for (size_t i = 0; i < 4 * bn; i++) fb[i] = (b[i / 4] >> (16 * (i % 4))) & 0xFFFF;
+    vector<uint64_t> twiddles = nttTwiddles(size, false);
+    nttForward(fa.data(), size, twiddles);
+    nttForward(fb.data(), size, twiddles);
+    uint64_t scale = powMod(size, NTT_PRIME - 2);
+    for (size_t i = 0; i < size; i++) fa[i] = mulMod(mulMod(fa[i], fb[i]), scale);
+    twiddles = nttTwiddles(size, true);
+    nttInverse(fa.data(), size, twiddles);
+
+    // Carry the convolution back into 16-bit digits
+    fill(out, out + an + bn, 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < digits; i++) {
+        uint64_t current = fa[i] + carry;
+        out[i / 4] |= (current & 0xFFFF) << (16 * (i % 4));
+        carry = current >> 16;
+    }
+}
+
+// Tier dispatch into the an + bn limbs at out. Karatsuba and Toom-3 want roughly balanced
+// operands, so a much longer operand is cut into chunks the size of the shorter one. Karatsuba
+// needs at least 4 limbs and Toom-3 at least 9, or their subproducts would not shrink
+void multiplyMagnitudes(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
+    if (an < bn) {
+        swap(a, b);
+        swap(an, bn);
+    }
+    if (bn < max<size_t>(crossovers.karatsuba, 4)) return schoolbookMultiply(a, an, b, bn, out);
+    if (bn >= crossovers.ntt) return nttMultiply(a, an, b, bn, out);
+    if (an > 2 * bn) {
+        fill(out, out + an + bn, 0);
+        vector<uint64_t> partial(2 * bn);
+        for (size_t offset = 0; offset < an; offset += bn) {
+            size_t length = min(bn, an - offset);
+            multiplyMagnitudes(a + offset, length, b, bn, partial.data());
+            addLimbs(out + offset, an + bn - offset, partial.data(), length + bn);
+        }
+        return;
+    }
+    if (bn < max<size_t>(crossovers.toom3, 9)) return karatsubaMultiply(a, an, b, bn, out);
+    toom3Multiply(a, an, b, bn, out);
+}
+
+// Time one n x n-limb multiply (best of a few runs)
+template <typename Multiply>
+double timeMultiply(Multiply multiply, size_t n, mt19937_64& generator) {
+    vector<uint64_t> a(n), b(n), out(2 * n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = generator();
+        b[i] = generator();
+    }
+    double best = 1e300, total = 0;
+    for (int run = 0; run < 50 && total < 2e-3; run++) {
+        auto start = chrono::steady_clock::now();
+        multiply(a.data(), n, b.data(), n, out.data());
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        best = min(best, seconds);
+        total += seconds;
+    }
+    return best;
+}
+
+// Each crossover is the first size at which the higher tier (one level, then dispatch) beats
+// the tiers below it, or twice the largest size tried if it never does
+void tuneMultiplicationCrossovers() {
+    mt19937_64 generator(1);
+    auto firstWin = [&](auto higher, const vector<size_t>& sizes) {
+        for (size_t n : sizes) {
+            if (timeMultiply(higher, n, generator) < timeMultiply(multiplyMagnitudes, n, generator)) return n;
         }
+        return 2 * sizes.back();
+    };
+    crossovers = {SIZE_MAX, SIZE_MAX, SIZE_MAX};
+    crossovers.karatsuba = firstWin(karatsubaMultiply, {8, 12, 16, 24, 32, 48, 64, 96, 128});
+    crossovers.toom3 = firstWin(toom3Multiply, {64, 96, 128, 192, 256, 384, 512, 768, 1024});
+    crossovers.ntt = firstWin(nttMultiply, {512, 1024, 2048, 4096, 8192, 16384, 32768});
+}
+
+//// Packed-Limb Multiplication Engine ////
+
+// Operands are loaded as magnitudes in 64-bit limbs (least significant limb first) and multiplied
+// with 64x64->128-bit partial products. The scratch buffers only ever grow, so once they have
+// reached the operand size a multiply below the Karatsuba crossover allocates nothing
+struct MultiplicationScratch {
+    vector<uint64_t> multiplicand;
+    vector<uint64_t> multiplier;
+    vector<uint64_t> product;
+};
+
+// Limbs in use (without leading zero limbs) and bit length of a magnitude
+size_t usedLimbs(const vector<uint64_t>& limbs) { return usedLimbs(limbs.data(), limbs.size()); }
+
+size_t bitLength(const vector<uint64_t>& limbs) {
+    size_t n = usedLimbs(limbs);
+    return n ? 64 * n - __builtin_clzll(limbs[n - 1]) : 0;
+}
 
-        // Add 1 to complete conversion
+// Load an MSB-first Two's Complement binary (binary[0] is the sign) as magnitude limbs; returns the sign
+bool loadMagnitude(const vector<bool>& binary, vector<uint64_t>& limbs) {
+    size_t width = binary.size();
+    limbs.assign((width + 63) / 64, 0);
+    for (size_t i = 0; i < width; i++) {
+        if (binary[width - 1 - i]) limbs[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+    bool isNegative = width > 0 && binary[0];
+    if (isNegative) {
+        // Magnitude = 2^width - value: flip, add 1, then clear the bits above width
         bool carry = 1;
-        for (size_t i = absBinary.size(); i-- > 0;) {
-            absBinary[i] = absBinary[i] ^ carry;
-            carry = absBinary[i] & carry;
+        for (uint64_t& limb : limbs) {
+            limb = ~limb + carry;
+            carry = carry && limb == 0;
         }
+        if (width % 64) limbs.back() &= ((uint64_t)1 << (width % 64)) - 1;
     }
+    return isNegative;
+}
+
+void loadMagnitude(int value, vector<uint64_t>& limbs) {
+    limbs.assign(1, value < 0 ? -(uint64_t)(int64_t)value : (uint64_t)value);
+}
 
-    // Calculate the integer value
-    int result = 0;
-    for (size_t i = 0; i < absBinary.size(); i++) {
-        result = (result << 1) + absBinary[i];
+// Multiply the loaded magnitudes and write the product in the shift-and-add output format:
+// bits(|multiplicand|) + bits(|multiplier|) + 1 bits, Two's Complement if the result is negative
+void multiplyLoaded(MultiplicationScratch& scratch, bool isNegativeResult, vector<bool>& product) {
+    size_t width = bitLength(scratch.multiplicand) + bitLength(scratch.multiplier) + 1;
+    size_t an = usedLimbs(scratch.multiplicand), bn = usedLimbs(scratch.multiplier);
+    scratch.product.assign(an + bn + 1, 0);
+    if (an && bn) multiplyMagnitudes(scratch.multiplicand.data(), an, scratch.multiplier.data(), bn, scratch.product.data());
+
+    // Two's complement on the way out: bits up to the lowest 1 are kept, the rest are flipped
+    product.assign(width, 0);
+    bool seenOne = false;
+    for (size_t i = 0; i < width; i++) {
+        bool bit = (scratch.product[i / 64] >> (i % 64)) & 1;
+        product[width - 1 - i] = (isNegativeResult && seenOne) ? !bit : bit;
+        seenOne = seenOne || bit;
     }
+}
 
-    return isNegative ? -result : result;
+// Allocation-free forms: the product vector and scratch are reused across calls
+void signedMultiplication(int multiplicand, int multiplier, vector<bool>& product, MultiplicationScratch& scratch) {
+    loadMagnitude(multiplicand, scratch.multiplicand);
+    loadMagnitude(multiplier, scratch.multiplier);
+    multiplyLoaded(scratch, (multiplicand < 0) ^ (multiplier < 0), product);
 }
 
-//// Multiplication Function ////
+void signedMultiplication(const vector<bool>& multiplicand, const vector<bool>& multiplier, vector<bool>& product,
+                          MultiplicationScratch& scratch) {
+    bool isNegativeResult = loadMagnitude(multiplicand, scratch.multiplicand) ^ loadMagnitude(multiplier, scratch.multiplier);
+    multiplyLoaded(scratch, isNegativeResult, product);
+}
+
+// Returning forms, using a per-thread scratch
 vector<bool> signedMultiplication(int multiplicand, int multiplier) {
-    bool isNegativeResult = (multiplicand < 0) ^ (multiplier < 0); // XOR to determine result sign
-    vector<bool> binaryMultiplicand = integerToBinary(abs(multiplicand));
-    vector<bool> binaryMultiplier = integerToBinary(abs(multiplier));
-    size_t size = binaryMultiplicand.size() + binaryMultiplier.size();
-    vector<bool> product(size, 0); // Initialize product with zeros
+    thread_local MultiplicationScratch scratch;
+    vector<bool> product;
+    signedMultiplication(multiplicand, multiplier, product, scratch);
+    return product;
+}
 
-    // Binary multiplication (shift-and-add method)
-    for (size_t i = binaryMultiplier.size(); i-- > 0;) {
-        if (binaryMultiplier[i]) {
-            vector<bool> shiftedMultiplicand = binaryMultiplicand; // Copy multiplicand
-            shiftedMultiplicand.resize(size, 0); // Pad with zeros for alignment
-            for (size_t j = shiftedMultiplicand.size(); j-- > 0;) {
-                product[j] = product[j] ^ shiftedMultiplicand[j];
-                bool carry = product[j] & shiftedMultiplicand[j];
-                if (carry) product.insert(product.begin(), 1); // Overflow bit for carry
+vector<bool> signedMultiplication(const vector<bool>& multiplicand, const vector<bool>& multiplier) {
+    thread_local MultiplicationScratch scratch;
+    vector<bool> product;
+    signedMultiplication(multiplicand, multiplier, product, scratch);
+    return product;
+}
+
+//// SIMD Batch Multiplication ////
+
+// Shift-and-add over many independent 32-bit operand pairs at once, one pair per 64-bit lane:
+// each step adds the (shifted) multiplicand magnitude into lanes whose current multiplier bit is
+// set and counts that partial product. The widest instruction set the CPU supports is picked
+// at runtime; results and counts come back as structure-of-arrays
+enum SimdLevel { ScalarLanes, AVX2Lanes, AVX512Lanes };
+
+struct BatchProducts {
+    vector<int64_t> products;
+    vector<uint8_t> partialProducts; // Multiplicand additions per pair (set bits of |multiplier|)
+};
+
+string simdLevelName(SimdLevel level) {
+    switch (level) {
+    case ScalarLanes: return "Scalar";
+    case AVX2Lanes: return "AVX2";
+    case AVX512Lanes: return "AVX-512";
+    }
+    return "Unknown";
+}
+
+SimdLevel detectSimdLevel() {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if (__builtin_cpu_supports("avx512f")) return AVX512Lanes;
+    if (__builtin_cpu_supports("avx2")) return AVX2Lanes;
+#endif
+    return ScalarLanes;
+}
+
+void scalarBatchMultiply(const int32_t* multiplicands, const int32_t* multipliers, size_t count, int64_t* products,
+                         uint8_t* partialProducts) {
+    for (size_t i = 0; i < count; i++) {
+        uint64_t a = multiplicands[i] < 0 ? -(uint64_t)(int64_t)multiplicands[i] : multiplicands[i];
+        uint64_t q = multipliers[i] < 0 ? -(uint64_t)(int64_t)multipliers[i] : multipliers[i];
+        uint64_t product = 0;
+        uint8_t additions = 0;
+        for (; q; q >>= 1, a <<= 1) {
+            if (q & 1) {
+                product += a;
+                additions++;
             }
         }
-        binaryMultiplicand.insert(binaryMultiplicand.end(), 0); // Left shift multiplicand
+        bool isNegativeResult = (multiplicands[i] < 0) ^ (multipliers[i] < 0);
+        products[i] = isNegativeResult ? -(int64_t)product : (int64_t)product;
+        partialProducts[i] = additions;
     }
+}
 
-    if (isNegativeResult) {
-        // Convert result to two's complement for negative numbers
-        for (size_t i = 0; i < product.size(); i++) {
-            product[i] = !product[i]; // Flip bits
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+__attribute__((target("avx2"))) void avx2BatchMultiply(const int32_t* multiplicands, const int32_t* multipliers,
+                                                        size_t count, int64_t* products, uint8_t* partialProducts) {
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi64x(1);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i a = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(multiplicands + i)));
+        __m256i q = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(multipliers + i)));
+        __m256i signA = _mm256_cmpgt_epi64(zero, a), signQ = _mm256_cmpgt_epi64(zero, q);
+        a = _mm256_sub_epi64(_mm256_xor_si256(a, signA), signA); // |a|
+        q = _mm256_sub_epi64(_mm256_xor_si256(q, signQ), signQ); // |q|
+
+        __m256i product = zero, additions = zero;
+        while (!_mm256_testz_si256(q, q)) {
+            __m256i bit = _mm256_and_si256(q, one);
+            __m256i take = _mm256_cmpeq_epi64(bit, one);
+            product = _mm256_add_epi64(product, _mm256_and_si256(take, a));
+            additions = _mm256_add_epi64(additions, bit);
+            a = _mm256_slli_epi64(a, 1);
+            q = _mm256_srli_epi64(q, 1);
         }
+        __m256i sign = _mm256_xor_si256(signA, signQ);
+        product = _mm256_sub_epi64(_mm256_xor_si256(product, sign), sign);
+        _mm256_storeu_si256((__m256i*)(products + i), product);
 
-        // Add 1 to complete two's complement
-        bool carry = 1;
-        for (size_t i = product.size(); i-- > 0;) {
-            product[i] = product[i] ^ carry;
-            carry = product[i] & carry;
+        alignas(32) int64_t counts[4];
+        _mm256_store_si256((__m256i*)counts, additions);
+        for (int lane = 0; lane < 4; lane++) partialProducts[i + lane] = (uint8_t)counts[lane];
+    }
+    scalarBatchMultiply(multiplicands + i, multipliers + i, count - i, products + i, partialProducts + i);
+}
+
+// GCC 12's AVX-512 intrinsics start from _mm512_undefined_epi32(), which trips -Wmaybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f"))) void avx512BatchMultiply(const int32_t* multiplicands, const int32_t* multipliers,
+                                                            size_t count, int64_t* products, uint8_t* partialProducts) {
+    const __m512i zero = _mm512_setzero_si512(), one = _mm512_set1_epi64(1);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i a = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(multiplicands + i)));
+        __m512i q = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(multipliers + i)));
+        __mmask8 sign = _mm512_cmplt_epi64_mask(a, zero) ^ _mm512_cmplt_epi64_mask(q, zero);
+        a = _mm512_abs_epi64(a);
+        q = _mm512_abs_epi64(q);
+
+        __m512i product = zero, additions = zero;
+        while (_mm512_test_epi64_mask(q, q)) {
+            __mmask8 take = _mm512_test_epi64_mask(q, one);
+            product = _mm512_mask_add_epi64(product, take, product, a);
+            additions = _mm512_mask_add_epi64(additions, take, additions, one);
+            a = _mm512_slli_epi64(a, 1);
+            q = _mm512_srli_epi64(q, 1);
         }
+        product = _mm512_mask_sub_epi64(product, sign, zero, product);
+        _mm512_storeu_si512(products + i, product);
+        _mm_storel_epi64((__m128i*)(partialProducts + i), _mm512_cvtepi64_epi8(additions));
+    }
+    scalarBatchMultiply(multiplicands + i, multipliers + i, count - i, products + i, partialProducts + i);
+}
+#pragma GCC diagnostic pop
+#endif
+
+// Multiply count pairs into out, which ends up holding exactly count results (its storage only grows,
+// so reusing one BatchProducts does not reallocate). A level above what the CPU supports falls back
+// to the best one it does
+void batchSignedMultiplication(const int32_t* multiplicands, const int32_t* multipliers, size_t count,
+                               BatchProducts& out, SimdLevel level = AVX512Lanes) {
+    static const SimdLevel supported = detectSimdLevel();
+    level = min(level, supported);
+    out.products.resize(count);
+    out.partialProducts.resize(count);
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if (level == AVX512Lanes) return avx512BatchMultiply(multiplicands, multipliers, count, out.products.data(), out.partialProducts.data());
+    if (level == AVX2Lanes) return avx2BatchMultiply(multiplicands, multipliers, count, out.products.data(), out.partialProducts.data());
+#endif
+    scalarBatchMultiply(multiplicands, multipliers, count, out.products.data(), out.partialProducts.data());
+}
 
-        if (carry) product.insert(product.begin(), 1); // Overflow bit for carry
+//// Multiplication Benchmark ////
+
+// Time and heap allocations (with COUNT_ALLOCATIONS) per multiply for the bit-level reference, the
+// returning API and the scratch-reusing form, on random operands of 8..31 bits
+void runMultiplicationBenchmark(size_t samples = 200000, uint64_t seed = 1) {
+    mt19937_64 generator(seed);
+    cout << "Width | Engine | ns/multiply | allocations/multiply\n";
+    for (int width : {8, 16, 31}) {
+        vector<pair<int, int>> operands(samples);
+        for (auto& pair : operands) {
+            pair.first = (int)(generator() % (1ULL << width)) - (1 << (width - 1));
+            pair.second = (int)(generator() % (1ULL << width)) - (1 << (width - 1));
+        }
+
+        size_t checksum = 0;
+        auto measure = [&](const string& engine, auto multiply) {
+#ifdef COUNT_ALLOCATIONS
+            uint64_t allocations = heapAllocations.load();
+#endif
+            auto start = chrono::steady_clock::now();
+            for (const auto& pair : operands) multiply(pair.first, pair.second);
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / samples;
+            cout << width << " | " << engine << " | " << ns << " | ";
+#ifdef COUNT_ALLOCATIONS
+            cout << (double)(heapAllocations.load() - allocations) / samples << "\n";
+#else
+            cout << "n/a (build with -DCOUNT_ALLOCATIONS)\n";
+#endif
+        };
+
+        measure("shift-and-add (bit-level)", [&](int a, int b) { checksum += shiftAndAddMultiplication(a, b).size(); });
+        measure("packed, returning", [&](int a, int b) { checksum += signedMultiplication(a, b).size(); });
+        MultiplicationScratch scratch;
+        vector<bool> product;
+        signedMultiplication((int)minOperand(width), (int)minOperand(width), product, scratch); // Size the buffers once
+        measure("packed, reused scratch", [&](int a, int b) {
+            signedMultiplication(a, b, product, scratch);
+            checksum += product.size();
+        });
+        if (checksum == 0) cout << "";
     }
+}
 
-    return product;
+// Time per multiply of each tier (higher tiers disabled; NTT forced at the top level) and of the tuned dispatch, on random
+// width-bit magnitudes from 64 bits up to maxBits. A tier is dropped once one multiply takes
+// longer than two seconds
+void runTierBenchmark(size_t maxBits = 10000000, uint64_t seed = 1) {
+    MultiplicationCrossovers tuned = crossovers;
+    const size_t off = SIZE_MAX;
+    typedef void (*Multiply)(const uint64_t*, size_t, const uint64_t*, size_t, uint64_t*);
+    struct Tier {
+        string name;
+        MultiplicationCrossovers crossovers;
+        Multiply multiply;
+    };
+    vector<Tier> tiers = {
+        {"Schoolbook", {off, off, off}, schoolbookMultiply},
+        {"Karatsuba", {tuned.karatsuba, off, off}, multiplyMagnitudes},
+        {"Toom-3", {tuned.karatsuba, tuned.toom3, off}, multiplyMagnitudes},
+        {"NTT", tuned, nttMultiply},
+        {"Auto", tuned, multiplyMagnitudes}};
+    vector<bool> dropped(tiers.size(), false);
+    mt19937_64 generator(seed);
+
+    cout << "Crossovers (limbs): Karatsuba " << tuned.karatsuba << ", Toom-3 " << tuned.toom3 << ", NTT " << tuned.ntt << "\n";
+    cout << "Width";
+    for (const Tier& tier : tiers) cout << " | " << tier.name << " us";
+    cout << "\n";
+
+    vector<size_t> widths = {64, 256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 10000000};
+    for (size_t width : widths) {
+        if (width > maxBits) break;
+        size_t n = (width + 63) / 64;
+        vector<uint64_t> a(n), b(n), expected, out(2 * n);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = generator();
+            b[i] = generator();
+        }
+        if (width % 64) {
+            a[n - 1] >>= 64 - width % 64;
+            b[n - 1] >>= 64 - width % 64;
+        }
+
+        cout << width;
+        crossovers = tuned; // The tuned dispatch is the reference for every tier
+        multiplyMagnitudes(a.data(), n, b.data(), n, out.data());
+        expected = out;
+        for (size_t t = 0; t < tiers.size(); t++) {
+            if (dropped[t]) {
+                cout << " | -";
+                continue;
+            }
+            crossovers = tiers[t].crossovers;
+            size_t runs = 0;
+            double seconds = 0;
+            auto start = chrono::steady_clock::now();
+            do {
+                tiers[t].multiply(a.data(), n, b.data(), n, out.data());
+                runs++;
+                seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            } while (seconds < 0.05);
+            cout << " | " << seconds / runs * 1e6 << (out == expected ? "" : " (MISMATCH)");
+            dropped[t] = seconds / runs > 2;
+        }
+        cout << "\n";
+    }
+    crossovers = tuned;
+}
+
+// Batch throughput per instruction set on random width-bit pairs, checked against the scalar lanes
+void runBatchBenchmark(size_t count = 1 << 20, uint64_t seed = 1) {
+    mt19937_64 generator(seed);
+    cout << "Detected: " << simdLevelName(detectSimdLevel()) << "\n";
+    cout << "Width | Lanes | ns/pair | partial products/pair\n";
+    for (int width : {8, 16, 32}) {
+        vector<int32_t> multiplicands(count), multipliers(count);
+        for (size_t i = 0; i < count; i++) {
+            multiplicands[i] = (int32_t)(minOperand(width) + (int64_t)(generator() % (1ULL << width)));
+            multipliers[i] = (int32_t)(minOperand(width) + (int64_t)(generator() % (1ULL << width)));
+        }
+        BatchProducts reference;
+        batchSignedMultiplication(multiplicands.data(), multipliers.data(), count, reference, ScalarLanes);
+        for (SimdLevel level : {ScalarLanes, AVX2Lanes, AVX512Lanes}) {
+            if (level > detectSimdLevel()) continue;
+            BatchProducts out;
+            batchSignedMultiplication(multiplicands.data(), multipliers.data(), count, out, level); // Warm up
+            auto start = chrono::steady_clock::now();
+            batchSignedMultiplication(multiplicands.data(), multipliers.data(), count, out, level);
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+            uint64_t additions = 0;
+            for (size_t i = 0; i < count; i++) additions += out.partialProducts[i];
+            bool matches = out.products == reference.products && out.partialProducts == reference.partialProducts;
+            cout << width << " | " << simdLevelName(level) << " | " << ns << " | " << (double)additions / count
+                 << (matches ? "" : " (MISMATCH)") << "\n";
+        }
+    }
+}
+
+//// Differential Verification ////
+
+// Every tier against schoolbook on random wide operands (balanced and unbalanced, with runs of
+// all-ones limbs to stress the carries). Low crossovers force deep recursion into each tier
+uint64_t verifyMultiplicationTiers(uint64_t samples, uint64_t seed = 1) {
+    MultiplicationCrossovers tuned = crossovers;
+    const size_t off = SIZE_MAX;
+    vector<pair<string, MultiplicationCrossovers>> tiers = {
+        {"Karatsuba", {4, off, off}}, {"Toom-3", {4, 9, off}}, {"NTT", {4, 9, 1}}, {"Auto", tuned}};
+    mt19937_64 generator(seed);
+    uint64_t mismatches = 0;
+    for (const auto& tier : tiers) {
+        uint64_t bad = 0;
+        for (uint64_t k = 0; k < samples; k++) {
+            size_t an = 1 + generator() % 400, bn = 1 + generator() % 400;
+            vector<uint64_t> a(an), b(bn), expected(an + bn), out(an + bn);
+            for (uint64_t& limb : a) limb = generator() % 4 ? generator() : ~(uint64_t)0;
+            for (uint64_t& limb : b) limb = generator() % 4 ? generator() : ~(uint64_t)0;
+            schoolbookMultiply(a.data(), an, b.data(), bn, expected.data());
+            crossovers = tier.second;
+            multiplyMagnitudes(a.data(), an, b.data(), bn, out.data());
+            if (out != expected) {
+                if (bad == 0) cout << "  " << tier.first << " tier: " << an << " x " << bn << " limbs mismatch\n";
+                bad++;
+            }
+        }
+        cout << tier.first << " tier: " << samples << " random products, " << bad << " mismatches\n";
+        mismatches += bad;
+    }
+    crossovers = tuned;
+    return mismatches;
+}
+
+// Check both multipliers against native multiplication: exhaustive at 8 (and optionally 16) bits,
+// random samples at the widths above that. The packed engine must also match the bit-level
+// output exactly, and its vector<bool> form is checked up to 62 bits
+void runVerification(size_t threads, uint64_t samples, int exhaustiveWidth) {
+    auto reference = [](int64_t a, int64_t b, int) { return binaryToInt128(shiftAndAddMultiplication((int)a, (int)b)); };
+    auto packed = [](int64_t a, int64_t b, int) -> __int128 {
+        vector<bool> product = signedMultiplication((int)a, (int)b);
+        return product == shiftAndAddMultiplication((int)a, (int)b) ? binaryToInt128(product) : (__int128)1 << 126;
+    };
+    auto packedWide = [](int64_t a, int64_t b, int width) {
+        return binaryToInt128(signedMultiplication(operandToBinary(a, width), operandToBinary(b, width)));
+    };
+    vector<VerificationReport> reports;
+    for (int width : {8, 16, 24, 31, 62}) {
+        if (width <= 31) {
+            if (width <= exhaustiveWidth) {
+                reports.push_back(verifyExhaustive("shiftAndAddMultiplication", width, reference, threads));
+                reports.push_back(verifyExhaustive("signedMultiplication", width, packed, threads));
+            } else {
+                reports.push_back(verifyRandom("shiftAndAddMultiplication", width, samples, reference, threads));
+                reports.push_back(verifyRandom("signedMultiplication", width, samples, packed, threads));
+            }
+        }
+        if (width <= exhaustiveWidth) reports.push_back(verifyExhaustive("signedMultiplication (binary)", width, packedWide, threads));
+        else reports.push_back(verifyRandom("signedMultiplication (binary)", width, samples, packedWide, threads));
+    }
+
+    uint64_t mismatches = 0;
+    for (const VerificationReport& report : reports) {
+        printVerificationReport(report);
+        mismatches += report.mismatches;
+    }
+    mismatches += verifyMultiplicationTiers(samples / 1000 + 1);
+
+    // Batch lanes, one pair per call so every level goes through its scalar tail as well as full vectors
+    for (SimdLevel level : {ScalarLanes, AVX2Lanes, AVX512Lanes}) {
+        if (level > detectSimdLevel()) continue;
+        auto batch = [level](int64_t a, int64_t b, int) -> __int128 {
+            int32_t multiplicands[9], multipliers[9];
+            fill(multiplicands, multiplicands + 9, (int32_t)a);
+            fill(multipliers, multipliers + 9, (int32_t)b);
+            BatchProducts out;
+            batchSignedMultiplication(multiplicands, multipliers, 9, out, level);
+            bool agree = all_of(out.products.begin(), out.products.end(), [&](int64_t p) { return p == out.products[0]; }) &&
+                         out.partialProducts[0] == __builtin_popcountll(b < 0 ? -(uint64_t)b : (uint64_t)b);
+            return agree ? out.products[0] : (__int128)1 << 126;
+        };
+        for (int width : {8, 16, 24, 32}) {
+            string name = "batch " + simdLevelName(level);
+            VerificationReport report = width <= exhaustiveWidth ? verifyExhaustive(name, width, batch, threads)
+                                                                 : verifyRandom(name, width, samples, batch, threads);
+            printVerificationReport(report);
+            mismatches += report.mismatches;
+        }
+    }
+    cout << (mismatches ? "FAIL" : "PASS") << "\n";
 }
 
 //// Main Function ////
-int main() {
+int main(int argc, char* argv[]) {
+    tuneMultiplicationCrossovers();
+
+    // Benchmark mode: Multiplication --bench [max bits]
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        runMultiplicationBenchmark();
+        runBatchBenchmark();
+        runTierBenchmark(argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000);
+        return 0;
+    }
+
+    // Verification mode: Multiplication --verify [threads] [samples] [exhaustive width]
+    if (argc > 1 && strcmp(argv[1], "--verify") == 0) {
+        uint64_t threads = max(1u, thread::hardware_concurrency()), samples = 1000000, exhaustiveWidth = 8;
+        if ((argc > 2 && !parseVerificationArgument(argv[2], 1, 4096, threads)) ||
+            (argc > 3 && !parseVerificationArgument(argv[3], 1, (uint64_t)1 << 40, samples)) ||
+            (argc > 4 && !parseVerificationArgument(argv[4], 0, maxExhaustiveWidth, exhaustiveWidth))) {
+            cerr << "Usage: Multiplication --verify [threads 1-4096] [samples 1-2^40] [exhaustive width 0-"
+                 << maxExhaustiveWidth << "]\n";
+            return 1;
+        }
+        runVerification(threads, samples, (int)exhaustiveWidth);
+        return 0;
+    }
+
     int multiplicand, multiplier;
 
     // Take inputs from the user
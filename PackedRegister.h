@@ -0,0 +1,222 @@
+#ifndef PACKED_REGISTER_H
+#define PACKED_REGISTER_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+//// Word-Packed Registers ////
+
+// Two's Complement register packed into 64-bit words (word 0 holds bits 0-63). The top word is kept
+// sign-extended past the register width, so shifts and adds work a word at a time and the sign is
+// always the top bit of the last word. Shared by the Booth, multiplication and division programs,
+// which still exchange numbers as MSB-first vector<bool> binaries at their edges
+struct PackedRegister {
+    std::vector<uint64_t> words;
+    size_t width;
+    PackedRegister(size_t width = 0) : words((width + 63) / 64 + 1, 0), width(width) {}
+
+    // Bit j (bits at or above width read as the sign)
+    bool bit(size_t j) const {
+        return j < 64 * words.size() ? (words[j / 64] >> (j % 64)) & 1 : isNegative();
+    }
+    bool isNegative() const { return words.back() >> 63; }
+};
+
+// Re-extend the sign bit (bit width - 1) through the rest of the storage
+inline void signExtend(PackedRegister& reg) {
+    if (reg.width == 0) {
+        for (uint64_t& word : reg.words) word = 0;
+        return;
+    }
+    size_t top = (reg.width - 1) / 64, bit = (reg.width - 1) % 64;
+    int64_t topWord = (int64_t)(reg.words[top] << (63 - bit)) >> (63 - bit);
+    reg.words[top] = topWord;
+    for (size_t i = top + 1; i < reg.words.size(); i++) reg.words[i] = topWord < 0 ? ~(uint64_t)0 : 0;
+}
+
+inline void setBit(PackedRegister& reg, size_t j, bool value) {
+    uint64_t mask = (uint64_t)1 << (j % 64);
+    reg.words[j / 64] = value ? reg.words[j / 64] | mask : reg.words[j / 64] & ~mask;
+    if (j + 1 >= reg.width) signExtend(reg);
+}
+
+// Load a binary number (MSB first, Two's Complement) sign-extended to width
+inline PackedRegister packBinary(const std::vector<bool>& binary, size_t width) {
+    PackedRegister reg(width);
+    size_t size = binary.size();
+    for (size_t j = 0; j < width; j++) {
+        bool bit = j < size ? binary[size - 1 - j] : (size ? binary[0] : 0);
+        if (bit) reg.words[j / 64] |= (uint64_t)1 << (j % 64);
+    }
+    signExtend(reg);
+    return reg;
+}
+
+// Load an integer, wrapped to width bits
+inline PackedRegister packInteger(int64_t value, size_t width) {
+    PackedRegister reg(width);
+    for (uint64_t& word : reg.words) word = value < 0 ? ~(uint64_t)0 : 0;
+    reg.words[0] = (uint64_t)value;
+    signExtend(reg);
+    return reg;
+}
+
+// Bits [from, from + count) as a binary number (MSB first)
+inline std::vector<bool> unpackBits(const PackedRegister& reg, size_t from, size_t count) {
+    std::vector<bool> binary(count);
+    for (size_t j = 0; j < count; j++) binary[count - 1 - j] = reg.bit(from + j);
+    return binary;
+}
+
+inline std::vector<bool> unpackBinary(const PackedRegister& reg) { return unpackBits(reg, 0, reg.width); }
+
+// Bits [from, from + count) as a count-bit register of their own (sign-extended from its top bit)
+inline PackedRegister extractPacked(const PackedRegister& reg, size_t from, size_t count) {
+    PackedRegister part(count);
+    size_t wordShift = from / 64, bitShift = from % 64;
+    for (size_t i = 0; i < part.words.size(); i++) {
+        uint64_t low = i + wordShift < reg.words.size() ? reg.words[i + wordShift] : (reg.isNegative() ? ~(uint64_t)0 : 0);
+        uint64_t high = i + wordShift + 1 < reg.words.size() ? reg.words[i + wordShift + 1] : (reg.isNegative() ? ~(uint64_t)0 : 0);
+        part.words[i] = bitShift ? (low >> bitShift) | (high << (64 - bitShift)) : low;
+    }
+    signExtend(part);
+    return part;
+}
+
+// Value of the register, wrapped to 64 bits (exact for widths up to 64)
+inline int64_t packedToInteger(const PackedRegister& reg) { return (int64_t)reg.words[0]; }
+
+inline void printPacked(const PackedRegister& reg, std::ostream& out = std::cout) {
+    for (size_t j = reg.width; j-- > 0;) out << reg.bit(j);
+}
+
+// reg += value (mod 2^width), one word-wide add per word; value is read sign-extended
+inline void addPacked(PackedRegister& reg, const PackedRegister& value) {
+    uint64_t carry = 0, extension = value.isNegative() ? ~(uint64_t)0 : 0;
+    for (size_t i = 0; i < reg.words.size(); i++) {
+        uint64_t addend = i < value.words.size() ? value.words[i] : extension;
+        uint64_t sum = reg.words[i] + addend;
+        uint64_t carryOut = sum < reg.words[i];
+        reg.words[i] = sum + carry;
+        carry = carryOut | (reg.words[i] < sum);
+    }
+    signExtend(reg);
+}
+
+// reg -= value (mod 2^width), as reg + NOT(value) + 1
+inline void subtractPacked(PackedRegister& reg, const PackedRegister& value) {
+    uint64_t borrow = 0, extension = value.isNegative() ? ~(uint64_t)0 : 0;
+    for (size_t i = 0; i < reg.words.size(); i++) {
+        uint64_t subtrahend = i < value.words.size() ? value.words[i] : extension;
+        uint64_t diff = reg.words[i] - subtrahend - borrow;
+        borrow = (reg.words[i] < subtrahend) | ((reg.words[i] - subtrahend) < borrow);
+        reg.words[i] = diff;
+    }
+    signExtend(reg);
+}
+
+// reg = -reg (Invert bits, then add 1). The inversion is a plain word loop the compiler
+// vectorizes; the +1 stops at the first word that does not wrap
+inline void negatePacked(PackedRegister& reg) {
+    for (uint64_t& word : reg.words) word = ~word;
+    for (uint64_t& word : reg.words) {
+        if (++word != 0) break;
+    }
+    signExtend(reg);
+}
+
+// reg <<= shift (mod 2^width)
+inline void shiftLeftPacked(PackedRegister& reg, size_t shift) {
+    size_t wordShift = shift / 64, bitShift = shift % 64;
+    for (size_t i = reg.words.size(); i-- > 0;) {
+        uint64_t word = i >= wordShift ? reg.words[i - wordShift] << bitShift : 0;
+        if (bitShift && i > wordShift) word |= reg.words[i - wordShift - 1] >> (64 - bitShift);
+        reg.words[i] = word;
+    }
+    signExtend(reg);
+}
+
+// Arithmetic right shift by fewer than 64 bits: one funnel shift per word
+inline void arithmeticShiftRight(PackedRegister& reg, unsigned shift) {
+    if (shift == 0) return;
+    size_t last = reg.words.size() - 1;
+    for (size_t i = 0; i < last; i++) {
+        reg.words[i] = (reg.words[i] >> shift) | (reg.words[i + 1] << (64 - shift));
+    }
+    reg.words[last] = (uint64_t)((int64_t)reg.words[last] >> shift);
+}
+
+//// Register Pairs ////
+
+// Two registers side by side in one packed register, high:low (as A:Q in the shift-and-add,
+// Booth and division hardware). Shifting the pair moves bits between the halves for free, and the
+// high half is updated by adding a value pre-shifted by lowWidth
+struct RegisterPair {
+    PackedRegister bits;
+    size_t lowWidth;
+    RegisterPair(size_t highWidth, size_t lowWidth) : bits(highWidth + lowWidth), lowWidth(lowWidth) {}
+
+    size_t highWidth() const { return bits.width - lowWidth; }
+    PackedRegister high() const { return extractPacked(bits, lowWidth, highWidth()); }
+    PackedRegister low() const { return extractPacked(bits, 0, lowWidth); }
+
+    void setLow(const PackedRegister& value) {
+        for (size_t j = 0; j < lowWidth; j++) setBit(bits, j, value.bit(j));
+    }
+    void setHigh(const PackedRegister& value) {
+        for (size_t j = 0; j < highWidth(); j++) setBit(bits, lowWidth + j, value.bit(j));
+    }
+
+    // value shifted up to line up with the high half, for addPacked/subtractPacked on bits
+    PackedRegister alignHigh(const PackedRegister& value) const {
+        PackedRegister aligned = packBinary(unpackBinary(value), bits.width);
+        shiftLeftPacked(aligned, lowWidth);
+        return aligned;
+    }
+};
+
+//// Bulk Register Operations ////
+
+// Wrap an array of registers of one width, stored one per word, to that width and sign-extend
+// them. A straight loop with no carries between elements, so it vectorizes. A 0-bit register
+// holds only 0; 64 bits is already extended
+inline void signExtendBatch(uint64_t* values, size_t count, size_t width) {
+    if (width >= 64) return;
+    if (width == 0) {
+        std::fill(values, values + count, 0);
+        return;
+    }
+    unsigned shift = 64 - (unsigned)width;
+    for (size_t i = 0; i < count; i++) values[i] = (uint64_t)((int64_t)(values[i] << shift) >> shift);
+}
+
+//// Binary Conversions ////
+
+// The MSB-first vector<bool> helpers every arithmetic program uses for input and display
+
+// Convert an integer to a bitWidth-bit binary (Two's Complement for negative numbers)
+inline std::vector<bool> integerToBinary(int64_t number, int bitWidth) {
+    return unpackBinary(packInteger(number, bitWidth));
+}
+
+// Shortest binary of an integer: the bare magnitude bits for non-negative numbers (no sign bit),
+// Two's Complement with a sign bit for negative ones
+inline std::vector<bool> integerToBinary(int64_t number) {
+    uint64_t magnitude = number < 0 ? 0 - (uint64_t)number : (uint64_t)number;
+    int width = magnitude ? 64 - __builtin_clzll(magnitude) : 0;
+    return integerToBinary(number, number < 0 ? width + 1 : width);
+}
+
+// Convert binary (Two's Complement, MSB first) to an integer, wrapped to 64 bits
+inline int64_t binaryToInteger(const std::vector<bool>& binary) {
+    return packedToInteger(packBinary(binary, binary.size()));
+}
+
+// Print binary representation
+inline void printBinary(const std::vector<bool>& binary, std::ostream& out = std::cout) {
+    for (bool bit : binary) out << bit;
+}
+
+#endif
@@ -2,139 +2,80 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <string>
+#include <sstream>
+#include "PackedRegister.h"
+#include "DivisionEngine.h"
+#include "DivisionBatch.h"
 
 using namespace std;
 
-//// Helper Functions ////
-
-// Convert an integer to binary (Two's Complement for negative numbers)
-vector<bool> integerToBinary(int number, int bitWidth) {
-    vector<bool> binary(bitWidth, 0); // Initialize with 0s
-    bool isNegative = (number < 0);  // Check if the number is negative
-
-    // Convert to binary (absolute value)
-    number = abs(number);
-    for (int i = bitWidth - 1; i >= 0; i--) {
-        binary[i] = number % 2;
-        number /= 2;
-    }
-
-    // If the number is negative, calculate the Two's Complement
-    if (isNegative) {
-        // Step 1: Invert bits
-        for (int i = 0; i < bitWidth; i++) {
-            binary[i] = !binary[i];
-        }
-        // Step 2: Add 1 to the LSB
-        bool carry = 1;
-        for (int i = bitWidth - 1; i >= 0; i--) {
-            binary[i] = binary[i] ^ carry; // XOR with carry
-            carry = binary[i] & carry;    // AND to propagate carry
-        }
-    }
-
-    return binary;
-}
-
-// Convert binary (Two's Complement) to integer
-int binaryToInteger(const vector<bool>& binary) {
-    bool isNegative = binary[0]; // Sign bit (MSB)
-    int bitWidth = binary.size();
-    vector<bool> absBinary = binary;
-
-    // If negative, convert from Two's Complement
-    if (isNegative) {
-        // Step 1: Invert bits
-        for (int i = 0; i < bitWidth; i++) {
-            absBinary[i] = !absBinary[i];
-        }
-        // Step 2: Add 1
-        bool carry = 1;
-        for (int i = bitWidth - 1; i >= 0; i--) {
-            absBinary[i] = absBinary[i] ^ carry;
-            carry = absBinary[i] & carry;
-        }
-    }
-
-    // Convert to integer
-    int result = 0;
-    for (int i = 0; i < bitWidth; i++) {
-        result = (result << 1) + absBinary[i];
-    }
-
-    return isNegative ? -result : result;
-}
-
-// Print binary representation
-void printBinary(const vector<bool>& binary) {
-    for (bool bit : binary) {
-        cout << bit;
-    }
-}
-
 //// Restoring Division Algorithm ////
-pair<vector<bool>, vector<bool>> restoringDivision(int dividend, int divisor, int bitWidth) {
-    // Step 1: Initialize Registers
-    vector<bool> A(bitWidth, 0); // Accumulator (A)
-    vector<bool> Q = integerToBinary(dividend, bitWidth); // Dividend (Q)
-    vector<bool> M = integerToBinary(divisor, bitWidth); // Divisor (M)
+// The step trace is a compile-time policy: TraceOff records nothing, TraceSummary records the
+// initial registers and the result, and TraceFull records every step to the sink
+template <TraceLevel Level>
+pair<vector<bool>, vector<bool>> restoringDivision(int dividend, int divisor, int bitWidth, DivisionTraceSink* trace = nullptr) {
+    // Step 1: Initialize Registers (with magnitudes; the signs are applied at the end). A:Q is one
+    // register pair, so the shift and the add/subtract on A are word-wide operations
+    RegisterPair AQ(bitWidth + 1, bitWidth); // Accumulator (A), one extra bit for the sign of A - M, above the dividend (Q)
+    AQ.setLow(packInteger(llabs((int64_t)dividend), bitWidth));
+    PackedRegister M = packInteger(llabs((int64_t)divisor), bitWidth + 1); // Divisor (M)
+    PackedRegister alignedM = AQ.alignHigh(M); // M lined up with A
     int count = bitWidth; // Number of iterations
 
-    cout << "Initial Values:\n";
-    cout << "A: "; printBinary(A); cout << "\n";
-    cout << "Q: "; printBinary(Q); cout << "\n";
-    cout << "M: "; printBinary(M); cout << "\n";
-    cout << "--------------------\n";
+    if constexpr (Level != TraceOff) {
+        trace->begin(TracedRestoring, bitWidth, dividend, divisor);
+        trace->event(TraceInitial, AQ.high(), AQ.low(), M);
+    }
 
     // Step 2: Restoring Division Iterations
     while (count > 0) {
-        // Step 2.1: Left shift A and Q
-        A.insert(A.begin(), Q.front()); // Shift Q's MSB into A's LSB
-        Q.erase(Q.begin());
-        Q.push_back(0); // Append 0 to Q
+        // Step 2.1: Left shift A and Q (Q's MSB moves into A's LSB, Q gets a 0)
+        shiftLeftPacked(AQ.bits, 1);
 
-        // Print current state after shift
-        cout << "After Left Shift:\n";
-        cout << "A: "; printBinary(A); cout << "\n";
-        cout << "Q: "; printBinary(Q); cout << "\n";
+        // Record current state after shift
+        if constexpr (Level == TraceFull) trace->event(TraceShift, AQ.high(), AQ.low());
 
         // Step 2.2: Subtract M from A (A = A - M)
-        vector<bool> tempA = A; // Temporary accumulator for restoration
-        bool borrow = 0;
-        for (int i = bitWidth - 1; i >= 0; i--) {
-            bool diff = A[i] ^ (!M[i]) ^ borrow;
-            borrow = (!A[i] & (!M[i])) | (borrow & (!A[i] ^ (!M[i])));
-            A[i] = diff;
-        }
-
-        cout << "After Subtraction (A - M):\n";
-        cout << "A: "; printBinary(A); cout << "\n";
+        subtractPacked(AQ.bits, alignedM);
+        if constexpr (Level == TraceFull) trace->event(TraceSubtract, AQ.high());
 
         // Step 2.3: Check if A is negative
-        if (A[0] == 1) {
-            // Restore A (negative result)
-            A = tempA; // Restore previous state
-            Q.back() = 0; // Append 0 to Q
-            cout << "A is Negative: Restoring A.\n";
+        if (AQ.bits.isNegative()) {
+            // Restore A (negative result), Q's new bit stays 0
+            addPacked(AQ.bits, alignedM);
+            if constexpr (Level == TraceFull) trace->event(TraceRestore);
         } else {
             // A is non-negative
-            Q.back() = 1; // Append 1 to Q
+            setBit(AQ.bits, 0, 1); // Append 1 to Q
         }
 
-        // Print current state
-        cout << "Updated State:\n";
-        cout << "A: "; printBinary(A); cout << "\n";
-        cout << "Q: "; printBinary(Q); cout << "\n";
-        cout << "--------------------\n";
+        // Record current state
+        if constexpr (Level == TraceFull) trace->event(TraceUpdate, AQ.high(), AQ.low());
 
         count--;
     }
 
-    return {A, Q}; // Return remainder (A) and quotient (Q)
+    // Step 3: Apply the signs: the quotient is negative when the signs differ, and the remainder
+    // takes the sign of the dividend
+    PackedRegister A = extractPacked(AQ.bits, bitWidth, bitWidth); // |remainder| < |divisor|, so it fits in bitWidth bits
+    PackedRegister Q = AQ.low();
+    if ((dividend < 0) != (divisor < 0)) negatePacked(Q);
+    if (dividend < 0) negatePacked(A);
+
+    if constexpr (Level != TraceOff) trace->event(TraceEnd, A, Q);
+    return {unpackBinary(A), unpackBinary(Q)}; // Return remainder (A) and quotient (Q)
 }
 
 //// Main Function ////
-int main() {
+int main(int argc, char* argv[]) {
+    // --bench, --batch, --columns, --trace and --replay (see runDivisionCli)
+    auto tracedDivide = [](auto level, int dividend, int divisor, int bitWidth, DivisionTraceSink* sink) {
+        return restoringDivision<decltype(level)::value>(dividend, divisor, bitWidth, sink);
+    };
+    int status;
+    if (runDivisionCli(argc, argv, tracedDivide, RestoringMode, status)) return status;
+
     int dividend, divisor;
 
     // Take inputs from the user
@@ -143,11 +84,22 @@ int main() {
     cout << "Enter the divisor (signed integer): ";
     cin >> divisor;
 
-    // Determine the bit width (based on magnitude of inputs)
-    int bitWidth = max(8, max(to_string(abs(dividend)).length() * 4, to_string(abs(divisor)).length() * 4));
+    if (divisor == 0) {
+        cerr << "Error: division by zero\n";
+        return 1;
+    }
+
+    // Determine the bit width (exactly what the operands and quotient need, at least 8 bits)
+    int bitWidth = max<int>(8, exactDivisionWidth(dividend, divisor));
 
     // Perform Restoring Division
-    auto [remainder, quotient] = restoringDivision(dividend, divisor, bitWidth);
+    // (recorded in memory, then replayed to cout)
+    ostringstream recorded;
+    DivisionTraceSink sink(recorded);
+    auto [remainder, quotient] = restoringDivision<TraceFull>(dividend, divisor, bitWidth, &sink);
+    sink.flush();
+    istringstream replay(recorded.str());
+    replayDivisionTrace(replay);
 
     // Display Results
     cout << "\nDividend: " << dividend << " (Binary: ";
@@ -166,5 +118,20 @@ int main() {
     printBinary(remainder);
     cout << "\nRemainder (Decimal): " << binaryToInteger(remainder) << "\n";
 
+    // The same division through every mode of the division engine
+    cout << "\nMode | Quotient | Remainder | Iterations\n";
+    for (DivisionMode mode : {RestoringMode, NonRestoringMode, SRTRadix4Mode, NewtonRaphsonMode, GoldschmidtMode}) {
+        DivisionResult result = divide(dividend, divisor, bitWidth, mode);
+        if (result.divisionByZero) {
+            cout << divisionModeName(mode) << " | division by zero\n";
+            continue;
+        }
+        cout << divisionModeName(mode) << " | " << binaryToInteger(result.quotient) << " | "
+             << binaryToInteger(result.remainder) << " | " << result.iterations << "\n";
+    }
+    DivisionResult prepared = divide(integerToBinary(dividend, bitWidth), prepareDivisor(divisor, bitWidth));
+    cout << "Prepared (multiply-shift) | " << binaryToInteger(prepared.quotient) << " | "
+         << binaryToInteger(prepared.remainder) << " | " << prepared.iterations << "\n";
+
     return 0;
 }